@@ -3,6 +3,7 @@
 #include "engine.h"
 
 #include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/usd/ar/resolverScopedCache.h>
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usdGeom/pointInstancer.h>
 #include <boost/algorithm/string.hpp>
@@ -28,27 +29,44 @@ public:
 
     RendererEngine& getEngine(
         const std::string& fileName,
-        const std::vector<std::string>& layers)
+        const std::vector<std::string>& layers,
+        const SdfPath& path)
     {
+        // The key is the hash of the content, so the procedurals with the same
+        // file and the same override layers share the engine, and the
+        // procedurals with the different overrides don't reuse the wrong one.
+        std::vector<std::string> content;
+        content.reserve(layers.size() + 1);
+        content.push_back(fileName);
+        content.insert(content.end(), layers.begin(), layers.end());
+        const std::string identifier =
+            WalterUSDCommonUtils::getContentHash(content);
+
         // It's possible that the procedurals request the engine at the same
         // time.
         ScopedLock lock(mMutex);
 
-        // TODO: Initialize and keep the cache with UsdStage ID or the hash, not
-        // with the filename.
-        auto it = mCache.find(fileName);
+        auto it = mCache.find(identifier);
         if (it == mCache.end())
         {
             auto result = mCache.emplace(
                 std::piecewise_construct,
-                std::forward_as_tuple(fileName),
-                std::forward_as_tuple(fileName, layers));
+                std::forward_as_tuple(identifier),
+                std::forward_as_tuple(identifier, fileName, layers, path));
             it = result.first;
         }
 
         return it->second;
     }
 
+    RendererEngine* findEngine(const std::string& identifier)
+    {
+        ScopedLock lock(mMutex);
+
+        auto it = mCache.find(identifier);
+        return it != mCache.end() ? &it->second : nullptr;
+    }
+
 private:
     typedef std::mutex Mutex;
     typedef std::lock_guard<Mutex> ScopedLock;
@@ -62,33 +80,106 @@ TF_INSTANTIATE_SINGLETON(EngineRegistry);
 
 RendererEngine* RendererEngine::getInstance(
     const std::string& fileName,
-    const std::vector<std::string>& layers)
+    const std::vector<std::string>& layers,
+    const SdfPath& path)
 {
     RendererEngine& engine =
-        EngineRegistry::getInstance().getEngine(fileName, layers);
+        EngineRegistry::getInstance().getEngine(fileName, layers, path);
     return &engine;
 }
 
+RendererEngine* RendererEngine::getInstance(const std::string& identifier)
+{
+    return EngineRegistry::getInstance().findEngine(identifier);
+}
+
 void RendererEngine::clearCaches()
 {
     EngineRegistry::getInstance().clear();
+    WalterUSDCommonUtils::clearSharedLayers();
 }
 
 RendererEngine::RendererEngine(
+    const std::string& identifier,
     const std::string& fileName,
-    const std::vector<std::string>& layers) :
-        mPlugin(),
+    const std::vector<std::string>& layers,
+    const SdfPath& path) :
+        mIdentifier(identifier),
+        mPlugin(identifier),
         mIndex(),
-        mDelegate(mIndex, mPlugin)
+        mDelegate(mIndex, mPlugin),
+        mRequestedPathsTaken(false)
+{
+    // The materials are always rendered and Walter keeps the expressions there,
+    // so they should be always in the population mask and loaded.
+    mRequestedPaths.insert(SdfPath("/materials"));
+
+    // The path of the procedural that created the engine is in the first mask,
+    // so it doesn't need to recompose the stage.
+    if (!path.IsEmpty())
+    {
+        mRequestedPaths.insert(path);
+    }
+
+    // Several procedurals with different files open their stages in parallel.
+    mStageOpened = std::async(
+                       std::launch::async,
+                       &RendererEngine::openStage,
+                       this,
+                       identifier,
+                       fileName,
+                       layers)
+                       .share();
+}
+
+void RendererEngine::prefetch(const SdfPath& path)
 {
+    if (path.IsEmpty())
+    {
+        return;
+    }
+
+    LoadLock lock(mLoadMutex);
+    if (!mRequestedPathsTaken)
+    {
+        mRequestedPaths.insert(path);
+    }
+}
+
+void RendererEngine::openStage(
+    const std::string& identifier,
+    const std::string& fileName,
+    const std::vector<std::string>& layers)
+{
+    // Resolve the layers once while the stage is opening.
+    ArResolverScopedCache cache;
+
     SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(fileName);
 
+    // We compose and load the payloads only for the objects requested by the
+    // procedurals while the stage was opening.
+    SdfPathSet toLoad;
+    {
+        LoadLock lock(mLoadMutex);
+        toLoad.swap(mRequestedPaths);
+        mRequestedPathsTaken = true;
+        mLoadedPaths.insert(toLoad.begin(), toLoad.end());
+
+        for (const SdfPath& path : toLoad)
+        {
+            mPopulationMask.Add(path);
+        }
+    }
+
+    UsdStageRefPtr stage;
+
     if (!layers.empty())
     {
-        // Create the layer-container with the sub-layers.
-        char layername[100];
-        sprintf(layername, "anonymous%i.usda", rand());
-        SdfLayerRefPtr overrideLayer = SdfLayer::CreateAnonymous(layername);
+        // Create the layer-container with the sub-layers. The names are formed
+        // from the content, so the same overrides always produce the same
+        // layers.
+        SdfLayerRefPtr overrideLayer =
+            SdfLayer::CreateAnonymous(identifier + ".usda");
         // List of the layer IDs to put it to the container.
         std::vector<std::string> allLayers;
         allLayers.reserve(layers.size());
@@ -98,12 +189,11 @@ RendererEngine::RendererEngine(
 
         for (const std::string& layer : layers)
         {
-            // We need a unique name because USD can open the previous layer if
-            // it has the same name.
-            // TODO: make a really unique name using UUID.
-            sprintf(layername, "anonymous%i.usda", rand());
-            SdfLayerRefPtr overrideLayer = SdfLayer::CreateAnonymous(layername);
-            if (overrideLayer->ImportFromString(layer))
+            // The procedurals often have the same override layers, so they are
+            // parsed only once and shared between the engines.
+            SdfLayerRefPtr overrideLayer =
+                WalterUSDCommonUtils::getSharedLayer(layer);
+            if (overrideLayer)
             {
                 allLayers.push_back(overrideLayer->GetIdentifier());
                 cacheLayers.push_back(overrideLayer);
@@ -114,19 +204,112 @@ RendererEngine::RendererEngine(
         overrideLayer->SetSubLayerPaths(allLayers);
 
         // Form the stage.
-        mStage = UsdStage::Open(root, overrideLayer);
+        stage = UsdStage::OpenMasked(
+            root, overrideLayer, mPopulationMask, UsdStage::LoadNone);
     }
 
-    if (!mStage)
+    if (!stage)
+    {
+        stage = UsdStage::OpenMasked(
+            root, mPopulationMask, UsdStage::LoadNone);
+    }
+
+    if (!stage)
+    {
+        return;
+    }
+
+    // The requested objects can point to the prims outside of the mask. For
+    // example, the prototypes of the point instancers.
+    stage->ExpandPopulationMask();
+    mPopulationMask = stage->GetPopulationMask();
+
+    // Load everything requested while the stage was opening at once.
+    stage->LoadAndUnload(toLoad, SdfPathSet());
+
+    // Nobody reads mStage until the future is ready.
+    mStage = stage;
+}
+
+void RendererEngine::waitForStage(const SdfPath& path)
+{
+    mStageOpened.wait();
+
+    if (!mStage || path.IsEmpty())
+    {
+        return;
+    }
+
+    {
+        LoadLock lock(mLoadMutex);
+        if (isLoaded(path))
+        {
+            return;
+        }
+    }
+
+    // It's a new root requested after the stage was opened. Widening the mask
+    // and loading modify the stage, so we need the exclusive access.
+    StageMutex::scoped_lock stageLock(mStageMutex, true);
+
     {
-        mStage = UsdStage::Open(root);
+        LoadLock lock(mLoadMutex);
+        if (isLoaded(path))
+        {
+            // Another procedural loaded it while we were waiting for the lock.
+            return;
+        }
     }
+
+    // The masters are composed and loaded with their instances and it's not
+    // allowed to load them directly.
+    const UsdPrim prim = mStage->GetPrimAtPath(path);
+    if (!prim || (!prim.IsMaster() && !prim.IsInMaster()))
+    {
+        if (!mPopulationMask.IncludesSubtree(path))
+        {
+            mPopulationMask.Add(path);
+            mStage->SetPopulationMask(mPopulationMask);
+            mStage->ExpandPopulationMask();
+            mPopulationMask = mStage->GetPopulationMask();
+        }
+
+        mStage->Load(path);
+    }
+
+    LoadLock lock(mLoadMutex);
+    mLoadedPaths.insert(path);
+}
+
+bool RendererEngine::isLoaded(const SdfPath& path) const
+{
+    // Look up the path and its ancestors instead of scanning all the loaded
+    // paths. There are many of them when the stage has many masters.
+    for (SdfPath p = path; !p.IsEmpty(); p = p.GetParentPath())
+    {
+        if (mLoadedPaths.find(p) != mLoadedPaths.end())
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 int RendererEngine::getNumNodes(
     const SdfPath& path,
     const std::vector<float>& times)
 {
+    // Only this stage is waited. The stages of the other procedurals continue
+    // opening in the background.
+    waitForStage(path);
+    if (!mStage)
+    {
+        return 0;
+    }
+
+    StageMutex::scoped_lock stageLock(mStageMutex, false);
+
     const UsdPrim prim = mStage->GetPrimAtPath(path);
     if (prim)
     {
@@ -175,6 +358,14 @@ void* RendererEngine::render(
     const std::vector<float>& times,
     const void* userData)
 {
+    waitForStage(path);
+    if (!mStage)
+    {
+        return nullptr;
+    }
+
+    StageMutex::scoped_lock stageLock(mStageMutex, false);
+
     // If the locations '/' or '/materials' are not in the hierarchy map,
     // create a walter procedural for /materials. This happend when the first
     // "objectPath" given to the procedural was a children of '/'.
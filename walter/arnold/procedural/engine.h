@@ -4,6 +4,10 @@
 #define __ENGINE_H__
 
 #include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/stagePopulationMask.h>
+#include <tbb/queuing_rw_mutex.h>
+#include <future>
+#include <mutex>
 #include <string>
 
 #include "delegate.h"
@@ -17,13 +21,28 @@ PXR_NAMESPACE_USING_DIRECTIVE
 class RendererEngine
 {
 public:
-    // Public constructor.
+    // Public constructor. It returns immediately, the stage is opened in a
+    // background thread. The path is the object path of the first procedural.
+    // It's in the population mask of the first opening.
     static RendererEngine* getInstance(
         const std::string& fileName,
-        const std::vector<std::string>& layers);
+        const std::vector<std::string>& layers,
+        const SdfPath& path = SdfPath());
+    // Return the existing engine with the given identifier or nullptr. The
+    // child procedurals use it to get the engine of the parent procedural.
+    static RendererEngine* getInstance(const std::string& identifier);
     // Remove all the cached RendererEngine objects.
     static void clearCaches();
 
+    /**
+     * @brief Requests loading the payloads of the given path. It doesn't wait
+     * for the stage. If the stage is still opening, the path is loaded in the
+     * background thread together with all the requested paths.
+     *
+     * @param path The object path of the procedural.
+     */
+    void prefetch(const SdfPath& path);
+
     // Number of nodes that is generated by the specified path.
     int getNumNodes(const SdfPath& path, const std::vector<float>& times);
 
@@ -34,22 +53,68 @@ public:
         const std::vector<float>& times,
         const void* userData);
 
+    // The content hash of the file name and the layers.
+    const std::string& getIdentifier() const { return mIdentifier; }
+
 private:
     friend class std::pair<const std::string, RendererEngine>;
 
     // We need to be sure that this object can be created only by registry.
+    // The identifier is the content hash of the file name and the layers. It's
+    // used to form the names of the Arnold nodes.
     RendererEngine(
+        const std::string& identifier,
+        const std::string& fileName,
+        const std::vector<std::string>& layers,
+        const SdfPath& path);
+
+    // Open the stage masked to the requested paths without payloads and load
+    // them. It's called in a background thread.
+    void openStage(
+        const std::string& identifier,
         const std::string& fileName,
         const std::vector<std::string>& layers);
 
+    // Wait until the stage is opened. If the path is not loaded yet, widen the
+    // population mask and load the payloads of the path.
+    void waitForStage(const SdfPath& path);
+
+    // Return true if the path or its parent is already loaded. The caller
+    // should lock mLoadMutex.
+    bool isLoaded(const SdfPath& path) const;
+
     // Prepare index.
     void prepare(const UsdPrim& root);
 
+    typedef tbb::queuing_rw_mutex StageMutex;
+    typedef std::lock_guard<std::mutex> LoadLock;
+
+    std::string mIdentifier;
+
     RendererPlugin mPlugin;
     RendererIndex mIndex;
     RendererDelegate mDelegate;
 
     UsdStageRefPtr mStage;
+
+    // Loading payloads modifies the stage. The procedurals read the stage with
+    // the reader lock, and the loading takes the writer lock.
+    StageMutex mStageMutex;
+
+    // The paths requested by the procedurals while the stage is opening and
+    // the paths already loaded. Once the stage has taken the requested paths,
+    // the new paths are loaded by waitForStage and not kept here.
+    SdfPathSet mRequestedPaths;
+    bool mRequestedPathsTaken;
+    SdfPathSet mLoadedPaths;
+    // Only the requested subtrees are composed.
+    UsdStagePopulationMask mPopulationMask;
+    mutable std::mutex mLoadMutex;
+
+    // The background task that opens the stage. It should be the last member
+    // because the task uses all the members above and the destructor of the
+    // future waits for the task.
+    std::shared_future<void> mStageOpened;
 };
 
 #endif
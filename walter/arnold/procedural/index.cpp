@@ -150,21 +150,39 @@ void RendererIndex::insertExpression(
     fullExpression += WalterCommon::demangleString(
         WalterCommon::convertRegex(expression));
 
+    // The expression is compiled once for all the layers and targets.
+    ChannelShaders& channelShaders =
+        mAssignments
+            .emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(fullExpression),
+                std::forward_as_tuple())
+            .first->second;
+
     // Iterate the layers.
     for (auto& l : layers)
     {
         // "defaultRenderLayer"
-        TargetToObjShader& currentLayer = mAssignments[l.first];
+        TargetToChannel& currentLayer = mChannels[l.first];
 
         for (auto& t : l.second)
         {
             // "shader"
             const std::string& targetName = t.first;
 
+            // Get or create the channel of this layer/target.
+            auto channelIt = currentLayer.find(targetName);
+            if (channelIt == currentLayer.end())
+            {
+                channelIt =
+                    currentLayer.emplace(targetName, mNumChannels++).first;
+            }
+            size_t channel = channelIt->second;
+
             // Filling mAssignments.
-            auto emplaceResult = currentLayer[targetName].emplace(
+            auto emplaceResult = channelShaders.shaders.emplace(
                 std::piecewise_construct,
-                std::forward_as_tuple(fullExpression),
+                std::forward_as_tuple(channel),
                 std::forward_as_tuple(t.second));
             if (!emplaceResult.second)
             {
@@ -175,6 +193,12 @@ void RendererIndex::insertExpression(
                 continue;
             }
 
+            if (channelShaders.channels.size() <= channel)
+            {
+                channelShaders.channels.resize(channel + 1);
+            }
+            channelShaders.channels.set(channel);
+
             // "/materials/aiStandard1"
             SdfPath& material = emplaceResult.first->second;
 
@@ -235,8 +259,8 @@ SdfPath RendererIndex::getShaderAssignment(
         const std::string& target)const
 {
     // Looking for requested render layer
-    auto layerIt = mAssignments.find(layer);
-    if (layerIt == mAssignments.end())
+    auto layerIt = mChannels.find(layer);
+    if (layerIt == mChannels.end())
     {
         return SdfPath();
     }
@@ -248,17 +272,30 @@ SdfPath RendererIndex::getShaderAssignment(
         return SdfPath();
     }
 
-    const ObjectToShader& objectList = targetIt->second;
+    size_t channel = targetIt->second;
+
+    // Only the expressions assigned in this channel are matched.
+    const ChannelShaders* channelShaders =
+        WalterCommon::resolveAssignment<ChannelShaders>(
+            objectName,
+            mAssignments,
+            [channel](const ChannelShaders& iChannelShaders) {
+                return channel < iChannelShaders.channels.size() &&
+                       iChannelShaders.channels.test(channel);
+            });
 
-    const SdfPath* shader =
-        WalterCommon::resolveAssignment<SdfPath>(objectName, objectList);
+    if (!channelShaders)
+    {
+        return SdfPath();
+    }
 
-    if (!shader)
+    auto shaderIt = channelShaders->shaders.find(channel);
+    if (shaderIt == channelShaders->shaders.end())
     {
         return SdfPath();
     }
 
-    return *shader;
+    return shaderIt->second;
 }
 
 const NameToAttribute* RendererIndex::getAttributes(SdfPath iOverridePath) const
@@ -11,6 +11,7 @@
 #include <pxr/base/tf/hashmap.h>
 #include <pxr/base/tf/hashset.h>
 #include <pxr/usd/sdf/path.h>
+#include <boost/dynamic_bitset.hpp>
 #include <tbb/concurrent_hash_map.h>
 
 #include <mutex>
@@ -118,7 +119,12 @@ public:
         const std::string& iAttributeName,
         const RendererAttribute& iAttribute);
 
-    // Get the assigned shader.
+    // Get the assigned shader. Each call matches the expressions of the given
+    // layer and target only. The targets of an object are requested from
+    // different nodes (the displacement from the reference, the shader from
+    // the instance, the attributes are cached by getObjectAttribute), so a
+    // single pass for all the targets would need to keep the result for each
+    // object.
     SdfPath getShaderAssignment(
             const std::string& objectName,
             const std::string& layer,
@@ -176,17 +182,30 @@ private:
     typedef TfHashSet<SdfPath, SdfPath::Hash> ObjectSet;
     typedef tbb::concurrent_hash_map<SdfPath, ObjectSet, TbbHash> ObjectMap;
 
+    // Each layer/target pair has a channel. It's the index of the bit in the
+    // bitset of the assignment.
+    // {"layer": {"target": channel}}
+    typedef std::unordered_map<std::string, size_t> TargetToChannel;
+    typedef std::unordered_map<std::string, TargetToChannel> Channels;
+
+    // The shaders of a single expression in all the layers and targets. The
+    // bit N of `channels` is set if the expression has an assignment in the
+    // channel N.
+    struct ChannelShaders
+    {
+        boost::dynamic_bitset<> channels;
+        std::unordered_map<size_t, SdfPath> shaders;
+    };
+
     // Building following structure:
-    // {"layer": {"target": {"object": "shader"}}}
+    // {"object": {channels, {channel: "shader"}}}
     // In Katana and Maya, we need to get the shader only if the shader is
     // really assigned to the object and we don't consider inheritance. But here
-    // we need to consider inheritance, so we need layer and target at the first
-    // layer for fast and easy extracting {"object": "shader"} because we need
-    // to ignore if it's another target or shader is assigned in another render
-    // layer.
-    typedef std::map<WalterCommon::Expression, SdfPath> ObjectToShader;
-    typedef std::unordered_map<std::string, ObjectToShader> TargetToObjShader;
-    typedef std::unordered_map<std::string, TargetToObjShader> Assignments;
+    // we need to consider inheritance. Each expression is compiled only once
+    // and it's shared between all the layers and targets. To get the shader of
+    // a layer and target, we only match the expressions that have the bit of
+    // the channel set.
+    typedef std::map<WalterCommon::Expression, ChannelShaders> Assignments;
 
     // Building following structure:
     // {"material": {"target": "shader"}}
@@ -213,6 +232,10 @@ private:
     RenderNodeMap mRenderNodeMap;
     // All the assignments of the cache.
     Assignments mAssignments;
+    // Layer/target to the channel of mAssignments.
+    Channels mChannels;
+    // The number of channels in mChannels.
+    size_t mNumChannels = 0;
     // Materials
     Materials mMaterials;
 
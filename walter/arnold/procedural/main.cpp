@@ -16,7 +16,7 @@ struct ProceduralData
         const std::string& filePaths,
         RendererEngine* engine,
         const SdfPath& path) :
-            mData{prefix, filePaths},
+            mData{prefix, filePaths, engine->getIdentifier()},
             mEngine(engine),
             mPath(path)
     {}
@@ -42,23 +42,6 @@ static int arnoldProceduralInit(AtNode* node, void** user_ptr)
     // Get parameters
     const char* file = AiNodeGetStr(node, "filePaths");
     const char* object = AiNodeGetStr(node, "objectPath");
-    const char* sessionLayer = AiNodeGetStr(node, "sessionLayer");
-    const char* variantsLayer = AiNodeGetStr(node, "variantsLayer");
-    const char* purposeLayer = AiNodeGetStr(node, "purposeLayer");
-    const char* mayaStateLayer = AiNodeGetStr(node, "mayaStateLayer");
-    const char* visibilityLayer = AiNodeGetStr(node, "visibilityLayer");
-
-    std::vector<std::string> overrides;
-    for (const char* o : {sessionLayer, variantsLayer, mayaStateLayer, visibilityLayer, purposeLayer})
-    {
-        if (o && o[0] != '\0')
-        {
-            overrides.push_back(o);
-        }
-    }
-
-    // Get USD stuff
-    RendererEngine* engine = RendererEngine::getInstance(file, overrides);
 
     SdfPath path;
     if(std::string(object) != "")
@@ -72,6 +55,46 @@ static int arnoldProceduralInit(AtNode* node, void** user_ptr)
             " Use '/' if you want to load the whole stage.");
     }
 
+    // The procedurals generated by Walter use the engine of the parent. It has
+    // the overrides and the index of the parent, and the overrides are not
+    // hashed again.
+    RendererEngine* engine = nullptr;
+    const char* engineIdentifier = AiNodeLookUpAndGetStr(node, "engine");
+    if (engineIdentifier && engineIdentifier[0] != '\0')
+    {
+        engine = RendererEngine::getInstance(engineIdentifier);
+    }
+
+    if (!engine)
+    {
+        const char* sessionLayer = AiNodeGetStr(node, "sessionLayer");
+        const char* variantsLayer = AiNodeGetStr(node, "variantsLayer");
+        const char* purposeLayer = AiNodeGetStr(node, "purposeLayer");
+        const char* mayaStateLayer = AiNodeGetStr(node, "mayaStateLayer");
+        const char* visibilityLayer = AiNodeGetStr(node, "visibilityLayer");
+
+        std::vector<std::string> overrides;
+        for (const char* o :
+             {sessionLayer,
+              variantsLayer,
+              mayaStateLayer,
+              visibilityLayer,
+              purposeLayer})
+        {
+            if (o && o[0] != '\0')
+            {
+                overrides.push_back(o);
+            }
+        }
+
+        // Get USD stuff. The stage is opened in the background, so the
+        // procedurals with different files don't wait for each other.
+        engine = RendererEngine::getInstance(file, overrides, path);
+    }
+
+    // The engine could be created by another procedural.
+    engine->prefetch(path);
+
     // Get the prefix. We need it because we produce a lot of objects. Each
     // of them should have the unique name. The idea that the root object
     // doesn't have a prefix attribute so that we can use the name as a
@@ -3,6 +3,8 @@
 #include "plugin.h"
 
 #include "index.h"
+#include "schemas/volume.h"
+#include "walterUSDCommonUtils.h"
 
 #include <ai.h>
 #include <boost/algorithm/string.hpp>
@@ -16,7 +18,6 @@
 #include <pxr/usd/usdGeom/pointInstancer.h>
 #include <pxr/usd/usdShade/connectableAPI.h>
 #include <pxr/usd/usdShade/shader.h>
-#include <tbb/atomic.h>
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
@@ -37,20 +38,6 @@ const AtParamEntry* getArnoldParameter(AtNode* node, const char* name)
     return AiNodeEntryLookUpParameter(AiNodeGetNodeEntry(node), name);
 }
 
-/**
- * @brief Each time it returns a unique string. It's thread safety.
- *
- * @return "0", "1", "2", etc...
- */
-inline std::string uniqueString()
-{
-    // An atomic value is a value that cannot be divided. Thus, thread safety.
-    // The advantage of atomic operations is that they are relatively quick
-    // compared to locks.
-    static tbb::atomic<unsigned int> counter(0);
-    return std::to_string(counter.fetch_and_increment());
-}
-
 /**
  * @brief Join instance root path and current path. It returns std::string
  * because when resolving shaders, we work with strings.
@@ -141,6 +128,9 @@ inline AtNode* createWalterProcedural(
 
     AiNodeSetStr(node, "filePaths", iData->filePaths.c_str());
 
+    AiNodeDeclare(node, "engine", "constant STRING");
+    AiNodeSetStr(node, "engine", iData->engine.c_str());
+
     AiNodeSetStr(node, "objectPath", iObjectPath.GetText());
 
     AiNodeDeclare(node, "prefix", "constant STRING");
@@ -496,6 +486,29 @@ RendererAttribute usdAttributeToArnold(
     return RendererAttribute(nullptr);
 }
 
+/**
+ * @brief Output the USD attribute to the Arnold parameter only if it's
+ * authored. Otherwise Arnold keeps its own default value.
+ *
+ * @param attr The USD attribute.
+ * @param node The Arnold node.
+ * @param name The name of the Arnold parameter.
+ * @param time The time to get the value.
+ */
+template <class T>
+void authoredAttributeToArnold(
+    const UsdAttribute& attr,
+    AtNode* node,
+    const char* name,
+    float time)
+{
+    T value;
+    if (attr.HasAuthoredValueOpinion() && attr.Get(&value, time))
+    {
+        aiNodeSet<T>(node, name, value);
+    }
+}
+
 // Push USD array attribute to Arnold.
 // It extracts data from USD attribute, converts the USD data type to the type
 // understandable by Arnold, and sets Arnold attribute.
@@ -834,7 +847,8 @@ uint8_t RendererAttribute::visibilityFlag() const
     return mVisibilityFlag;
 }
 
-RendererPlugin::RendererPlugin()
+RendererPlugin::RendererPlugin(const std::string& iIdentifier) :
+        mIdentifier(iIdentifier)
 {
 #if 0
     TfDebug::Enable(WALTER_ARNOLD_PLUGIN);
@@ -848,7 +862,8 @@ bool RendererPlugin::isSupported(const UsdPrim& prim) const
         return false;
     }
     return prim.IsInstance() || prim.IsA<UsdGeomMesh>() ||
-           prim.IsA<UsdGeomCurves>() || prim.IsA<UsdGeomPointInstancer>();
+           prim.IsA<UsdGeomCurves>() || prim.IsA<UsdGeomPointInstancer>() ||
+           prim.IsA<WalterVolume>();
 }
 
 bool RendererPlugin::isImmediate(const UsdPrim& prim) const
@@ -913,11 +928,17 @@ void* RendererPlugin::outputBBox(
     if (prim.IsInstance())
     {
         objectPath = prim.GetMaster().GetPath();
-        prefix = data->prefix + "_" + uniqueString();
+
+        // The full path that is good for expression resolving. It's unique for
+        // each instance, so we use it to form the prefix. It makes the names
+        // of the nodes the same from one render to another.
+        const std::string instancePath =
+            joinPaths(index.getPrefixPath(data->prefix), path);
+        prefix = data->prefix + "_" +
+            WalterUSDCommonUtils::getContentHash(instancePath);
 
         // Save the full path that is good for expression resolving.
-        index.setPrefixPath(
-            prefix, joinPaths(index.getPrefixPath(data->prefix), path));
+        index.setPrefixPath(prefix, instancePath);
     }
     else
     {
@@ -1013,8 +1034,9 @@ void* RendererPlugin::outputReference(
 {
     assert(prim);
 
-    std::string name = prim.GetStage()->GetSessionLayer()->GetIdentifier() +
-                       ":" + prim.GetPath().GetText();
+    // The identifier of the session layer is different each time, so we use
+    // the identifier of the stage which depends only on the content.
+    std::string name = mIdentifier + ":" + prim.GetPath().GetText();
 
     AtNode* node = nullptr;
 
@@ -1026,6 +1048,10 @@ void* RendererPlugin::outputReference(
     {
         node = outputGeomCurves(prim, times, name.c_str(), userData);
     }
+    else if (prim.IsA<WalterVolume>())
+    {
+        node = outputVolume(prim, times, name.c_str(), userData);
+    }
     else if (prim.IsA<UsdShadeShader>())
     {
         node = outputShader(prim, times, name.c_str());
@@ -1363,6 +1389,97 @@ AtNode* RendererPlugin::outputGeomCurves(
     return node;
 }
 
+AtNode* RendererPlugin::outputVolume(
+    const UsdPrim& prim,
+    const std::vector<float>& times,
+    const char* name,
+    const void* userData) const
+{
+    TF_DEBUG(WALTER_ARNOLD_PLUGIN)
+        .Msg("[%s]: Render: %s\n", __FUNCTION__, name);
+
+    size_t keys = times.size();
+    float averageTime =
+        std::accumulate(times.begin(), times.end(), 0.0f) / keys;
+
+    WalterVolume volume(prim);
+
+    // We only give Arnold the name of the VDB file. Arnold reads the file and
+    // computes the bounds when it needs the volume, so nothing is parsed when
+    // the scene is built.
+    std::string filename;
+    volume.GetFilenameAttr().Get(&filename, averageTime);
+
+    VtUCharArray filedata;
+    if (filename.empty() &&
+        !volume.GetFiledataAttr().Get(&filedata, averageTime))
+    {
+        TF_DEBUG(WALTER_ARNOLD_PLUGIN)
+            .Msg("[%s]: Skipping %s because it has no data\n",
+                 __FUNCTION__,
+                 name);
+        return nullptr;
+    }
+
+    // Create a volume.
+    AtNode* node = AiNode("volume");
+
+    AiNodeSetStr(node, "name", name);
+    AiNodeSetByte(node, "visibility", 0);
+
+    const RendererPluginData* data =
+        reinterpret_cast<const RendererPluginData*>(userData);
+    assert(data);
+
+    setMotionStartEnd(node, *data);
+
+    if (!filename.empty())
+    {
+        AiNodeSetStr(node, "filename", filename.c_str());
+    }
+    else if (!filedata.empty())
+    {
+        // The volume is embedded.
+        AiNodeSetArray(
+            node,
+            "filedata",
+            AiArrayConvert(
+                filedata.size(), 1, AI_TYPE_BYTE, filedata.cdata()));
+    }
+
+    VtStringArray grids;
+    if (volume.GetGridsAttr().Get(&grids, averageTime) && !grids.empty())
+    {
+        AtArray* array = AiArrayAllocate(grids.size(), 1, AI_TYPE_STRING);
+        for (size_t i = 0; i < grids.size(); i++)
+        {
+            AiArraySetStr(array, i, grids[i].c_str());
+        }
+        AiNodeSetArray(node, "grids", array);
+    }
+
+    authoredAttributeToArnold<float>(
+        volume.GetStepSizeAttr(), node, "step_size", averageTime);
+    authoredAttributeToArnold<float>(
+        volume.GetStepScaleAttr(), node, "step_scale", averageTime);
+    authoredAttributeToArnold<bool>(
+        volume.GetCompressAttr(), node, "compress", averageTime);
+    authoredAttributeToArnold<float>(
+        volume.GetVolumePaddingAttr(), node, "volume_padding", averageTime);
+    authoredAttributeToArnold<float>(
+        volume.GetVelocityScaleAttr(), node, "velocity_scale", averageTime);
+    authoredAttributeToArnold<float>(
+        volume.GetVelocityFpsAttr(), node, "velocity_fps", averageTime);
+    authoredAttributeToArnold<float>(
+        volume.GetVelocityOutlierThresholdAttr(),
+        node,
+        "velocity_outlier_threshold",
+        averageTime);
+
+    // Return node.
+    return node;
+}
+
 AtNode* RendererPlugin::outputShader(
     const UsdPrim& prim,
     const std::vector<float>& times,
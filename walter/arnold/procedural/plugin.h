@@ -19,6 +19,9 @@ struct RendererPluginData
 {
     std::string prefix;
     std::string filePaths;
+    // The identifier of the engine. The child procedurals use the engine of
+    // the parent, so they see the same overrides and the same index.
+    std::string engine;
     boost::optional<float> motionStart;
     boost::optional<float> motionEnd;
 };
@@ -82,7 +85,14 @@ private:
 class RendererPlugin
 {
 public:
-    RendererPlugin();
+    /**
+     * @brief Constructs the plugin.
+     *
+     * @param iIdentifier The identifier of the stage. It's used as a prefix of
+     * the reference nodes. It should only depend on the content of the stage,
+     * so the same stage produces the same node names in every render.
+     */
+    RendererPlugin(const std::string& iIdentifier);
 
     // True if it's a supported privitive.
     bool isSupported(const UsdPrim& prim) const;
@@ -154,6 +164,23 @@ private:
         const char* name,
         const void* userData) const;
 
+    /**
+     * @brief Output Arnold volume from WalterVolume. The VDB file is not read
+     * here, Arnold loads it lazily.
+     *
+     * @param prim WalterVolume prim.
+     * @param times The motion samples.
+     * @param name The name of the Arnold node.
+     * @param userData The arnold user data.
+     *
+     * @return The Arnold node or nullptr if the volume has no data.
+     */
+    AtNode* outputVolume(
+        const UsdPrim& prim,
+        const std::vector<float>& times,
+        const char* name,
+        const void* userData) const;
+
     AtNode* outputShader(
         const UsdPrim& prim,
         const std::vector<float>& times,
@@ -236,6 +263,9 @@ private:
      * @return The Arnold node.
      */
     void* outputEmptyNode(const std::string& iNodeName) const;
+
+    // The identifier of the stage.
+    std::string mIdentifier;
 };
 
 #endif
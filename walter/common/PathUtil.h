@@ -168,13 +168,17 @@ private:
  *
  * @param iFullName Full object name
  * @param iExpressions All the assignments in sorted map.
+ * @param iFilter The functor that takes the second element of the map and
+ * returns false if the assignment should be skipped. It's called before
+ * matching, so the skipped expressions are never evaluated.
  *
  * @return The pointer to the second element of the map.
  */
-template <class T>
+template <class T, class F>
 T const* resolveAssignment(
     const std::string& iFullName,
-    const std::map<Expression, T>& iExpressions)
+    const std::map<Expression, T>& iExpressions,
+    F iFilter)
 {
     T const* shader = nullptr;
 
@@ -185,6 +189,11 @@ T const* resolveAssignment(
     // the parent close to the root.
     for (const auto& object : boost::adaptors::reverse(iExpressions))
     {
+        if (!iFilter(object.second))
+        {
+            continue;
+        }
+
         const Expression& expr = object.first;
 
         bool isItself = false;
@@ -211,6 +220,24 @@ T const* resolveAssignment(
 
     return shader;
 }
+
+/**
+ * @brief Check the map with all the assignments and return the assignment that
+ * closely fits the specified object name.
+ *
+ * @param iFullName Full object name
+ * @param iExpressions All the assignments in sorted map.
+ *
+ * @return The pointer to the second element of the map.
+ */
+template <class T>
+T const* resolveAssignment(
+    const std::string& iFullName,
+    const std::map<Expression, T>& iExpressions)
+{
+    return resolveAssignment(
+        iFullName, iExpressions, [](const T&) { return true; });
+}
 }
 
 #endif
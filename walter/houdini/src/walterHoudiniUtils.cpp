@@ -5,6 +5,7 @@
 #include "walterUSDCommonUtils.h"
 
 #include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/usd/ar/resolverScopedCache.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usdGeom/curves.h>
@@ -28,6 +29,7 @@ public:
         auto it = mStages.find(stageName);
         if (it == mStages.end())
         {
+            ArResolverScopedCache cache;
             SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(stageName);
 
             auto result = mStages.emplace(stageName, UsdStage::Open(root));
@@ -7,6 +7,7 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
+#include <atomic>
 #include <unordered_map>
 
 #include <FnAttribute/FnAttribute.h>
@@ -50,7 +51,7 @@ struct ScalarProp
 class AbcCook
 {
 public:
-    AbcCook() { animatedSchema = false; }
+    AbcCook() : isInitialized(false) { animatedSchema = false; }
 
     Foundry::Katana::GroupAttribute staticGroup;
 
@@ -63,6 +64,9 @@ public:
     Alembic::Abc::IObjectPtr objPtr;
     boost::mutex mutex;
 
+    // True when staticGroup and the properties are filled by initAbcCook.
+    std::atomic<bool> isInitialized;
+
     bool animatedSchema;
 };
 
@@ -1,5 +1,6 @@
 #include "ArbitraryGeomParamUtils.h"
 #include "ArrayPropUtils.h"
+#include "walterCookProfiler.h"
 #include <Alembic/AbcGeom/All.h>
 
 #include <FnAttribute/FnAttribute.h>
@@ -535,6 +536,8 @@ void processArbGeomParams( AbcCookPtr ioCook,
         return;
     }
 
+    OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Primvars);
+
     std::string attrPath = "geometry.arbitrary.";
     for (size_t i = 0; i < iParent.getNumProperties(); ++i)
     {
@@ -14,11 +14,15 @@
 #include <FnGeolib/util/AttributeKeyedCache.h>
 #include <FnGeolibServices/FnGeolibCookInterfaceUtilsService.h>
 
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/usd/ar/resolverScopedCache.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usdLux/light.h>
 #include <pxr/usd/usdGeom/camera.h>
 
 #include "AbcCook.h"
+#include "walterCookProfiler.h"
+#include "walterUSDOpUtils.h"
 #include "ArrayPropUtils.h"
 #include "ArbitraryGeomParamUtils.h"
 #include "ScalarPropUtils.h"
@@ -30,10 +34,27 @@
 #include <hdf5.h>  // for H5dont_atexit
 
 #include <boost/algorithm/string.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
 
+TF_DEFINE_ENV_SETTING(
+    WALTER_ALEMBIC_CACHE_SIZE,
+    100,
+    "The maximum number of the Alembic archives kept open by WalterIn.");
+
+TF_DEFINE_ENV_SETTING(
+    WALTER_ALEMBIC_NUM_STREAMS,
+    4,
+    "The maximum number of the streams opened per Ogawa archive by WalterIn.");
+
 namespace { // anonymous
 
 /**
@@ -97,9 +118,9 @@ public:
                               Alembic::Abc::IObject & iParent,
                               const std::string & iName)
     {
-        boost::lock_guard<boost::mutex> lock(mutex);
-        std::map<std::string, WalterIn::AbcCookPtr>::iterator it =
-            pathMap.find(iFullName);
+        // It's called for each child from several threads, so the map is
+        // concurrent and we don't lock it.
+        PathToCook::const_iterator it = pathMap.find(iFullName);
         if (it != pathMap.end())
         {
             return it->second;
@@ -108,13 +129,16 @@ public:
         WalterIn::AbcCookPtr cookPtr(new WalterIn::AbcCook());
         cookPtr->objPtr =
             Alembic::Abc::IObjectPtr(new Alembic::Abc::IObject(iParent, iName));
-        pathMap[iFullName] = cookPtr;
-        return cookPtr;
+
+        // If another thread inserted the same object in the meantime, we
+        // return the object of the other thread.
+        return pathMap.insert(std::make_pair(iFullName, cookPtr)).first->second;
     }
 
 private:
-    std::map<std::string, WalterIn::AbcCookPtr> pathMap;
-    boost::mutex mutex;
+    typedef tbb::concurrent_unordered_map<std::string, WalterIn::AbcCookPtr>
+        PathToCook;
+    PathToCook pathMap;
 };
 
 typedef boost::shared_ptr< PathMap > PathMapPtr;
@@ -140,6 +164,20 @@ typedef std::pair<GroupAttribute, GroupAttribute> AttributePair;
 typedef std::unordered_map<std::string, AttributePair> Attributes;
 typedef boost::shared_ptr<Attributes> AttributesPtr;
 
+// The assignments resolved for a single object. The material is the name of
+// the shader and the displacement joined with '_', the attributes is the name
+// of the walterOverride material.
+struct ObjectAssignment
+{
+    std::string material;
+    std::string attributes;
+};
+
+// The assignments already resolved in the archive by the full name of the
+// object.
+typedef tbb::concurrent_unordered_map<std::string, ObjectAssignment>
+    ResolvedAssignments;
+
 // Some of the KTOA attributes don't match to the Arnold attributes. We receive
 // Arnold attributes, and we need to make KTOA understanding them. The only way
 // to do it is remapping them.
@@ -294,6 +332,85 @@ std::string getShaderAssignment(
     return result.substr(0, result.find('.'));
 }
 
+// Resolves the shader, the displacement and the attribute assignments of the
+// object by matching all the expressions.
+ObjectAssignment resolveObjectAssignment(
+    const std::string& iObjectName,
+    const AssignmentsPtr& iAssignments)
+{
+    const std::string shader =
+        getShaderAssignment(iObjectName, iAssignments, "shader");
+    const std::string displacement =
+        getShaderAssignment(iObjectName, iAssignments, "displacement");
+
+    ObjectAssignment assignment;
+    if (!shader.empty() && !displacement.empty())
+    {
+        assignment.material = shader + "_" + displacement;
+    }
+    else
+    {
+        assignment.material = shader + displacement;
+    }
+
+    assignment.attributes =
+        getShaderAssignment(iObjectName, iAssignments, "attribute");
+
+    return assignment;
+}
+
+// Resolves the assignments of the children of the object. The parent resolves
+// them for all its children at once, so the expressions are matched in
+// parallel, and only the assignments of the expanded locations are kept. The
+// resolved assignments are saved to ioResolved, so when the location is cooked
+// again, the expressions are not matched again.
+std::vector<ObjectAssignment> resolveChildAssignments(
+    const Alembic::Abc::IObject& iParent,
+    const AssignmentsPtr& iAssignments,
+    ResolvedAssignments& ioResolved)
+{
+    const size_t numChildren = iParent.getNumChildren();
+    std::vector<ObjectAssignment> resolved(numChildren);
+
+    if (!iAssignments || iAssignments->empty())
+    {
+        return resolved;
+    }
+
+    // Only the headers are needed to get the names of the objects. They are
+    // read in a single thread because it's not safe with HDF5.
+    std::vector<std::string> names;
+    names.reserve(numChildren);
+    for (size_t i = 0; i < numChildren; i++)
+    {
+        names.push_back(iParent.getChildHeader(i).getFullName());
+    }
+
+    // Matching the expressions is the expensive part, and it doesn't touch the
+    // archive.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numChildren),
+        [&names, &resolved, &iAssignments, &ioResolved](
+            const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                auto it = ioResolved.find(names[i]);
+                if (it != ioResolved.end())
+                {
+                    resolved[i] = it->second;
+                    continue;
+                }
+
+                // Several threads can resolve the same object, the result is
+                // the same.
+                resolved[i] = resolveObjectAssignment(names[i], iAssignments);
+                ioResolved.insert(std::make_pair(names[i], resolved[i]));
+            }
+        });
+
+    return resolved;
+}
+
 // Analyze the assignments and make a list of materials with both surface and
 // displacement shaders.
 bool produceShaderSets(
@@ -361,29 +478,73 @@ struct ArchiveAndFriends
 {
     ArchiveAndFriends(Alembic::Abc::IArchive & iArchive,
                       Alembic::AbcCoreFactory::IFactory::CoreType iCoreType) :
-        pathMap(new PathMap()),
-        assignments(new TargetToAssignments()),
-        attributes(boost::make_shared<Attributes>()),
-        shaderSet(new ShaderSet())
+        pathMap(new PathMap())
     {
         objArchive = iArchive.getTop();
         coreType = iCoreType;
-        // Read and initialize assignments
-        readAssignments(objArchive, assignments);
-        readAttributes(objArchive, attributes);
-        produceShaderSets(assignments, shaderSet);
+    }
+
+    // The assignments, the attributes and the shader sets are read at the
+    // first request, so the archives that are only expanded don't parse the
+    // attributes and the locations without attributes don't need them. Several
+    // threads can request them at the same time.
+    const AssignmentsPtr& getAssignments()
+    {
+        std::call_once(assignmentsAreRead, [this]() {
+            assignments.reset(new TargetToAssignments());
+            readAssignments(objArchive, assignments);
+        });
+
+        return assignments;
+    }
+
+    const AttributesPtr& getAttributes()
+    {
+        std::call_once(attributesAreRead, [this]() {
+            attributes = boost::make_shared<Attributes>();
+            readAttributes(objArchive, attributes);
+        });
+
+        return attributes;
+    }
+
+    const ShaderSetPtr& getShaderSet()
+    {
+        std::call_once(shaderSetIsProduced, [this]() {
+            shaderSet.reset(new ShaderSet());
+            produceShaderSets(getAssignments(), shaderSet);
+        });
+
+        return shaderSet;
+    }
+
+    // Resolves the assignments of the children of the object. The result is
+    // memoized for the life of the archive.
+    std::vector<ObjectAssignment> resolveChildAssignments(
+        const Alembic::Abc::IObject& iParent)
+    {
+        return ::resolveChildAssignments(
+            iParent, getAssignments(), resolvedAssignments);
     }
 
     Alembic::Abc::IObject objArchive;
     Alembic::AbcCoreFactory::IFactory::CoreType coreType;
     PathMapPtr pathMap;
+
+private:
+    std::once_flag assignmentsAreRead;
+    std::once_flag attributesAreRead;
+    std::once_flag shaderSetIsProduced;
+
     // All the assignments of the cache
     AssignmentsPtr assignments;
 
-	AttributesPtr attributes;
+    AttributesPtr attributes;
     // List of materials with both surface and displacement shaders.
     ShaderSetPtr shaderSet;
 
+    // The assignments of the expanded objects.
+    ResolvedAssignments resolvedAssignments;
 };
 
 class AlembicCache :
@@ -391,9 +552,20 @@ class AlembicCache :
 {
 public:
     AlembicCache() :
-        FnGeolibUtil::AttributeKeyedCache< ArchiveAndFriends >(100, 1000)
+        FnGeolibUtil::AttributeKeyedCache< ArchiveAndFriends >(
+            TfGetEnvSetting(WALTER_ALEMBIC_CACHE_SIZE), 1000),
+        mNumArchives(0)
     {
         factory.setPolicy(Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+
+        // The locations are cooked concurrently, so the threads should be
+        // able to read the archive without waiting for the others. Each
+        // stream is a file handle kept open for every archive of the cache, so
+        // the number of them is limited.
+        const unsigned numStreams = std::min(
+            std::max(1u, std::thread::hardware_concurrency()),
+            (unsigned)std::max(1, TfGetEnvSetting(WALTER_ALEMBIC_NUM_STREAMS)));
+        setNumStreams(numStreams);
     }
 
     // number of streams to open per file
@@ -402,6 +574,18 @@ public:
         factory.setOgawaNumStreams( iNumStreams );
     }
 
+    // Outputs the number of the archives opened since the last flush. If it's
+    // much bigger than the number of the archives of the scene, the archives
+    // are evicted and opened again, and WALTER_ALEMBIC_CACHE_SIZE should be
+    // increased.
+    void reportStats()
+    {
+        TF_DEBUG(WALTER_KATANA).Msg(
+            "[WALTER]: %zu Alembic archives were opened, the cache keeps %d\n",
+            mNumArchives.exchange(0),
+            TfGetEnvSetting(WALTER_ALEMBIC_CACHE_SIZE));
+    }
+
 private:
     AlembicCache::IMPLPtr createValue(const FnAttribute::Attribute & iAttr)
     {
@@ -417,12 +601,15 @@ private:
         if ( archive.valid() )
         {
             val.reset(new ArchiveAndFriends(archive, coreType));
+            mNumArchives++;
         }
 
         return val;
     }
 
     Alembic::AbcCoreFactory::IFactory factory;
+
+    std::atomic<size_t> mNumArchives;
 };
 
 #if defined(__clang__)
@@ -436,6 +623,8 @@ AlembicCache g_cache;
 #pragma clang diagnostic pop
 #endif
 
+typedef AlembicCache::IMPLPtr ArchiveAndFriendsPtr;
+
 class WalterInPrivateData : public Foundry::Katana::GeolibPrivateData
 {
 public:
@@ -449,12 +638,11 @@ public:
 
     WalterIn::AbcCookPtr cookPtr;
     PathMapPtr pathMap;
-    // All the assignments of the cache
-    AssignmentsPtr assignments;
-    // All the attributes
-    AttributesPtr attributes;
-    // List of materials with both surface and displacement shaders.
-    ShaderSetPtr shaderSet;
+    // The archive with the assignments, the attributes and the shader sets.
+    // They are read when the cook needs them.
+    ArchiveAndFriendsPtr friends;
+    // The assignments of this object resolved by the parent.
+    ObjectAssignment assignment;
     // TODO: use reference
     std::string root;
     // Pointer to material inside shaderSet. Used to generate virtual materials.
@@ -470,9 +658,7 @@ WalterIn::AbcCookPtr getTopObject(
         const FnAttribute::StringAttribute & iRootAttr,
         std::string & oOpType,
         PathMapPtr & oPathMap,
-        AssignmentsPtr& oAssignments,
-        AttributesPtr& oAttributes,
-        ShaderSetPtr& oShaderSet)
+        ArchiveAndFriendsPtr& oFriends)
 {
     WalterIn::AbcCookPtr retVal;
     Alembic::Abc::IObject obj;
@@ -538,9 +724,7 @@ WalterIn::AbcCookPtr getTopObject(
     }
 
     oPathMap = entry->pathMap;
-    oAssignments = entry->assignments;
-    oAttributes = entry->attributes;
-    oShaderSet = entry->shaderSet;
+    oFriends = entry;
     return retVal;
 }
 
@@ -638,6 +822,16 @@ static FnAttribute::GroupAttribute getAllProps(
     const Foundry::Katana::GeolibCookInterface &interface,
     const WalterIn::AbcCookPtr &ioCookPtr)
 {
+    FnAttribute::GroupAttribute staticGroup;
+    {
+        // Query to ioCookPtr->staticGroup should be locked. It's not locked
+        // in the original Alembic because they don't have setAttributes()
+        // and they don't access it from there. We only copy the handle under
+        // the lock and use it after.
+        boost::lock_guard<boost::mutex> lock(ioCookPtr->mutex);
+        staticGroup = ioCookPtr->staticGroup;
+    }
+
     if (!ioCookPtr->arrayProps.empty() || !ioCookPtr->scalarProps.empty() ||
         ioCookPtr->objPtr || ioCookPtr->visProp.valid())
     {
@@ -676,14 +870,7 @@ static FnAttribute::GroupAttribute getAllProps(
             (useOnlyShutterOpenCloseTimesFlag == 1);
 
         FnAttribute::GroupBuilder bld;
-
-        {
-            // Query to ioCookPtr->staticGroup should be locked. It's not locked
-            // in the original Alembic because they don't have setAttributes()
-            // and they don't access it from there.
-            boost::lock_guard<boost::mutex> lock(ioCookPtr->mutex);
-            bld.deepUpdate(ioCookPtr->staticGroup);
-        }
+        bld.deepUpdate(staticGroup);
 
         Alembic::Abc::IUInt64ArrayProperty idsProp;
         Alembic::Abc::IUInt64ArrayProperty * iIdsProperty = NULL;
@@ -743,7 +930,7 @@ static FnAttribute::GroupAttribute getAllProps(
 
     }
     // no animation set our static attrs
-    return ioCookPtr->staticGroup;
+    return staticGroup;
 }
 
 static void setAllAttrs(Foundry::Katana::GeolibCookInterface &interface,
@@ -758,33 +945,16 @@ static void setAllAttrs(Foundry::Katana::GeolibCookInterface &interface,
 // Set the material. Returns material assigned on the current object or parent.
 static std::string setAssignment(
         Foundry::Katana::GeolibCookInterface &interface,
-        const std::string& iName,
-        const AssignmentsPtr& iAssignments,
+        const ObjectAssignment& iAssignment,
         const std::string& iRoot,
         const std::string& iParentMaterial)
 {
-    const std::string shader =
-        getShaderAssignment(iName, iAssignments, "shader");
-    const std::string displacement =
-        getShaderAssignment(iName, iAssignments, "displacement");
-
-    std::vector<std::string> names;
-    if (!shader.empty())
-    {
-        names.push_back(shader);
-    }
-    if (!displacement.empty())
-    {
-        names.push_back(displacement);
-    }
-
-    if (names.empty())
+    if (iAssignment.material.empty())
     {
         return "";
     }
 
-    const std::string material =
-        iRoot + "/materials/" + boost::algorithm::join(names, "_");
+    const std::string material = iRoot + "/materials/" + iAssignment.material;
 
     if (material != iParentMaterial)
     {
@@ -802,15 +972,12 @@ static std::string setAssignment(
 // Set the material. Returns material assigned on the current object or parent.
 static std::string setAttributes(
         const WalterIn::AbcCookPtr &ioCookPtr,
-        const AssignmentsPtr& iAssignments,
+        const ObjectAssignment& iAssignment,
         const AttributesPtr& iAttributes,
         const std::string& iRoot,
         const std::string& iParentAttributes)
 {
-    const std::string& name = ioCookPtr->objPtr->getFullName();
-
-    const std::string attributes =
-        getShaderAssignment(name, iAssignments, "attribute");
+    const std::string& attributes = iAssignment.attributes;
 
     if (attributes.empty())
     {
@@ -853,14 +1020,12 @@ static std::string setAttributes(
 // Katana locations (usually generated by a WalterInOp).
 static std::string setAttributes(
         Foundry::Katana::GeolibCookInterface &iInterface,
-        const std::string& iName,
-        const AssignmentsPtr& iAssignments,
+        const ObjectAssignment& iAssignment,
         const AttributesPtr& iAttributes,
         const std::string& iRoot,
         const std::string& iParentAttributes)
 {
-    const std::string attributes =
-        getShaderAssignment(iName, iAssignments, "attribute");
+    const std::string& attributes = iAssignment.attributes;
 
     if (attributes.empty())
     {
@@ -883,8 +1048,8 @@ static std::string setAttributes(
 static void fillAllProps(
         Foundry::Katana::GeolibCookInterface &interface,
         WalterIn::AbcCookPtr ioCookPtr,
-        const AssignmentsPtr& iAssignments,
-        const AttributesPtr& iAttributes,
+        const ArchiveAndFriendsPtr& iFriends,
+        const ObjectAssignment& iAssignment,
         const std::string& iRoot,
         const std::string& iParentMaterial,
         std::string& oAssignedMaterial,
@@ -892,17 +1057,32 @@ static void fillAllProps(
 {
     fillRootInfo(interface, ioCookPtr);
 
-    oAssignedMaterial = setAssignment(
-        interface,
-        ioCookPtr->objPtr->getFullName(),
-        iAssignments,
-        iRoot,
-        iParentMaterial);
+    {
+        OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Assignments);
+
+        oAssignedMaterial =
+            setAssignment(interface, iAssignment, iRoot, iParentMaterial);
+
+        // The attributes are read only if something is assigned.
+        if (!iAssignment.attributes.empty())
+        {
+            oAssignedAttributes = setAttributes(
+                ioCookPtr,
+                iAssignment,
+                iFriends->getAttributes(),
+                iRoot,
+                iParentMaterial);
+        }
+    }
 
-    oAssignedAttributes = setAttributes(
-        ioCookPtr, iAssignments, iAttributes, iRoot, iParentMaterial);
+    FnAttribute::GroupAttribute allProps;
+    {
+        // The animated properties are read here.
+        OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Geometry);
+        allProps = getAllProps(interface, ioCookPtr);
+    }
 
-    FnAttribute::GroupAttribute allProps = getAllProps(interface, ioCookPtr);
+    OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Attributes);
     setAllAttrs(interface, allProps);
 }
 
@@ -911,21 +1091,40 @@ static void cookAlembic(
         const std::string & iOpType,
         WalterIn::AbcCookPtr ioCookPtr,
         PathMapPtr & iPathMap,
-        const AssignmentsPtr& iAssignments,
-        const AttributesPtr& iAttributes,
-        const ShaderSetPtr& iShaderSet,
+        const ArchiveAndFriendsPtr& iFriends,
+        const ObjectAssignment& iAssignment,
         const std::string& iRoot,
         const std::string& iParentMaterial)
 {
-    if (!ioCookPtr->staticGroup.isValid())
+    OpUtils::CookProfiler profiler("WalterIn");
+
+    if (OpUtils::CookProfiler::isEnabled())
+    {
+        const Alembic::Abc::IObject& object = *ioCookPtr->objPtr;
+        const std::string& fullName = object.getFullName();
+        profiler.setLocation(
+            object.getMetaData().get("schema"),
+            fullName,
+            std::count(fullName.begin(), fullName.end(), '/'));
+    }
+
+    // The flag is atomic, so the objects that are already initialized don't
+    // need to lock the mutex.
+    if (!ioCookPtr->isInitialized.load(std::memory_order_acquire))
     {
+        OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Geometry);
         boost::lock_guard<boost::mutex> lock(ioCookPtr->mutex);
 
-        if (!ioCookPtr->staticGroup.isValid())
+        if (!ioCookPtr->isInitialized.load(std::memory_order_relaxed))
         {
-            FnAttribute::GroupBuilder staticBld;
-            WalterIn::initAbcCook(ioCookPtr, staticBld);
-            ioCookPtr->staticGroup = staticBld.build();
+            if (!ioCookPtr->staticGroup.isValid())
+            {
+                FnAttribute::GroupBuilder staticBld;
+                WalterIn::initAbcCook(ioCookPtr, staticBld);
+                ioCookPtr->staticGroup = staticBld.build();
+            }
+
+            ioCookPtr->isInitialized.store(true, std::memory_order_release);
         }
     }
 
@@ -934,8 +1133,8 @@ static void cookAlembic(
     fillAllProps(
             interface,
             ioCookPtr,
-            iAssignments,
-            iAttributes,
+            iFriends,
+            iAssignment,
             iRoot,
             iParentMaterial,
             assignedMaterial,
@@ -976,6 +1175,13 @@ static void cookAlembic(
         childOpArgs = newOpArgs.build();
     }
 
+    std::vector<ObjectAssignment> childAssignments;
+    {
+        OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Assignments);
+        childAssignments =
+            iFriends->resolveChildAssignments(*ioCookPtr->objPtr);
+    }
+
     std::size_t numChildren = ioCookPtr->objPtr->getNumChildren();
 
     for (std::size_t i = 0; i < numChildren; ++i)
@@ -986,11 +1192,14 @@ static void cookAlembic(
         WalterInPrivateData * childData = new WalterInPrivateData();
 
         childData->pathMap = iPathMap;
-        childData->assignments = iAssignments;
-        childData->attributes = iAttributes;
-        childData->shaderSet = iShaderSet;
-        childData->cookPtr = iPathMap->get(header.getFullName(),
-            *ioCookPtr->objPtr, header.getName());
+        childData->friends = iFriends;
+        childData->assignment = std::move(childAssignments[i]);
+        {
+            // Opening the child reads it from the archive.
+            OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Stage);
+            childData->cookPtr = iPathMap->get(header.getFullName(),
+                *ioCookPtr->objPtr, header.getName());
+        }
         childData->root = iRoot;
         childData->parentMaterial = assignedMaterial;
 
@@ -1002,13 +1211,15 @@ static void cookAlembic(
     if (ioCookPtr->objPtr->getFullName() == "/materials")
     {
         // Add virtual shaders.
-        BOOST_FOREACH (const auto& material, *iShaderSet)
+        BOOST_FOREACH (const auto& material, *iFriends->getShaderSet())
         {
             std::string name = material.first + "_" + material.second;
 
             WalterInPrivateData * childData = new WalterInPrivateData();
 
             childData->pathMap = iPathMap;
+            // The material points to the shader set of the archive.
+            childData->friends = iFriends;
             childData->root = iRoot;
             childData->material = &material;
             childData->cookPtr = ioCookPtr;
@@ -1048,9 +1259,8 @@ public:
                 "WalterInHDF",
                 privateData->cookPtr,
                 privateData->pathMap,
-                privateData->assignments,
-                privateData->attributes,
-                privateData->shaderSet,
+                privateData->friends,
+                privateData->assignment,
                 privateData->root,
                 privateData->parentMaterial);
     }
@@ -1122,14 +1332,15 @@ public:
         const std::string objPath = inputLocation.substr(root.size());
         AlembicCache::IMPLPtr entry = g_cache.getValue(fileAttr);
 
-        setAssignment(interface, objPath, entry->assignments, root, "");
-        setAttributes(
-            interface,
-            objPath,
-            entry->assignments,
-            entry->attributes,
-            root,
-            "");
+        const ObjectAssignment assignment =
+            resolveObjectAssignment(objPath, entry->getAssignments());
+
+        setAssignment(interface, assignment, root, "");
+        if (!assignment.attributes.empty())
+        {
+            setAttributes(
+                interface, assignment, entry->getAttributes(), root, "");
+        }
     }
 };
 
@@ -1157,9 +1368,8 @@ public:
                 "WalterInOgawa",
                 privateData->cookPtr,
                 privateData->pathMap,
-                privateData->assignments,
-                privateData->attributes,
-                privateData->shaderSet,
+                privateData->friends,
+                privateData->assignment,
                 privateData->root,
                 privateData->parentMaterial);
     }
@@ -1282,9 +1492,7 @@ public:
             interface.getOpArg("pathFromRoot");
 
         PathMapPtr pathMap;
-        AssignmentsPtr assignments;
-        AttributesPtr attributes;
-        ShaderSetPtr shaderSet;
+        ArchiveAndFriendsPtr friends;
         std::string opType;
 
         WalterIn::AbcCookPtr curObj =
@@ -1293,9 +1501,7 @@ public:
                     pathFromRootAttr,
                     opType,
                     pathMap,
-                    assignments,
-                    attributes,
-                    shaderSet);
+                    friends);
 
         const std::string filePath = fileAttr.getValue();
         // Check and report our error conditions
@@ -1376,6 +1582,9 @@ public:
         }
 
         // invoke the children
+        std::vector<ObjectAssignment> childAssignments =
+            friends->resolveChildAssignments(*curObj->objPtr);
+
         std::size_t numChildren = curObj->objPtr->getNumChildren();
 
         for (std::size_t i = 0; i < numChildren; ++i)
@@ -1386,9 +1595,8 @@ public:
             WalterInPrivateData * childData = new WalterInPrivateData();
 
             childData->pathMap = pathMap;
-            childData->assignments = assignments;
-            childData->attributes = attributes;
-            childData->shaderSet = shaderSet;
+            childData->friends = friends;
+            childData->assignment = std::move(childAssignments[i]);
             childData->cookPtr = pathMap->get(header.getFullName(),
                 *curObj->objPtr, header.getName());
             childData->root = interface.getOutputLocationPath();
@@ -1402,6 +1610,7 @@ public:
 
     static void flush()
     {
+        g_cache.reportStats();
         g_cache.clear();
     }
 };
@@ -1446,7 +1655,34 @@ private:
         std::vector<std::string> cameras, lights;
         if (isUSD)
         {
-            SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(archives);
+            ArResolverScopedCache cache;
+
+            // There are no cameras and lights in the ass files, so only their
+            // hierarchy is read and Arnold is not started. The layers are
+            // anonymous, so we keep them until the stage is closed.
+            std::vector<SdfLayerRefPtr> metadataLayers;
+            std::vector<std::string> layers;
+            layers.reserve(archives.size());
+            for (const std::string& f : archives)
+            {
+                SdfLayerRefPtr layer;
+                if (boost::iends_with(f, ".ass"))
+                {
+                    layer = SdfLayer::OpenAsAnonymous(f, /*metadataOnly*/ true);
+                }
+
+                if (layer)
+                {
+                    metadataLayers.push_back(layer);
+                    layers.push_back(layer->GetIdentifier());
+                }
+                else
+                {
+                    layers.push_back(f);
+                }
+            }
+
+            SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(layers);
             const UsdStageRefPtr stage = UsdStage::Open(root);
 
             UsdPrim rootPrim = stage->GetPseudoRoot();
@@ -0,0 +1,305 @@
+// Copyright 2017 Rodeo FX.  All rights reserved.
+
+#include "walterCookProfiler.h"
+
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/tf/envSetting.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TF_DEFINE_ENV_SETTING(
+    WALTER_COOK_PROFILE,
+    "",
+    "The file to write the cook profile of WalterIn to when Katana exits. It's "
+    "CSV if the file ends with .csv and JSON otherwise. Empty disables it.");
+
+namespace
+{
+typedef OpUtils::CookProfiler CookProfiler;
+
+const char* sPhaseNames[CookProfiler::NumPhases] = {
+    "stage", "geometry", "primvars", "assignments", "attributes", "other"};
+
+// The location that is cooked in the current thread.
+thread_local CookProfiler* tCurrent = nullptr;
+
+/** @brief Accumulates the cooks of the locations with the same op, type and
+ * depth. */
+struct CookStats
+{
+    CookStats() : count(0), total(0.0), max(0.0)
+    {
+        std::fill(phases, phases + CookProfiler::NumPhases, 0.0);
+    }
+
+    size_t count;
+    double total;
+    double max;
+    // The path of the location that took the max time.
+    std::string slowest;
+    double phases[CookProfiler::NumPhases];
+};
+
+std::string escapeJSON(const std::string& iStr)
+{
+    std::string result;
+    result.reserve(iStr.size());
+    for (char c : iStr)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+        result += c;
+    }
+
+    return result;
+}
+
+std::string escapeCSV(const std::string& iStr)
+{
+    return "\"" + boost::algorithm::replace_all_copy(iStr, "\"", "\"\"") +
+        "\"";
+}
+
+/** @brief Keeps the stats of all the cooks of the process and writes them when
+ * the process exits. */
+class CookRegistry
+{
+public:
+    // The op, the type and the depth.
+    typedef std::tuple<std::string, std::string, size_t> Key;
+    typedef std::pair<Key, CookStats> Item;
+
+    CookRegistry() : mFileName(TfGetEnvSetting(WALTER_COOK_PROFILE)) {}
+    ~CookRegistry() { write(); }
+
+    void add(
+        const char* iOpType,
+        const std::string& iType,
+        const std::string& iPath,
+        size_t iDepth,
+        double iTotal,
+        const double* iPhases)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        CookStats& stats = mStats[Key(iOpType, iType, iDepth)];
+        stats.count++;
+        stats.total += iTotal;
+        if (iTotal > stats.max)
+        {
+            stats.max = iTotal;
+            stats.slowest = iPath;
+        }
+
+        for (int i = 0; i < CookProfiler::NumPhases; i++)
+        {
+            stats.phases[i] += iPhases[i];
+        }
+    }
+
+private:
+    void write()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mFileName.empty() || mStats.empty())
+        {
+            return;
+        }
+
+        // The most expensive first.
+        std::vector<Item> items(mStats.begin(), mStats.end());
+        std::sort(
+            items.begin(), items.end(), [](const Item& a, const Item& b) {
+                return a.second.total > b.second.total;
+            });
+
+        std::ofstream file(mFileName);
+        if (!file)
+        {
+            TF_WARN(
+                "[WALTER]: Can't write the cook profile to %s",
+                mFileName.c_str());
+            return;
+        }
+
+        if (boost::algorithm::iends_with(mFileName, ".csv"))
+        {
+            writeCSV(items, file);
+        }
+        else
+        {
+            writeJSON(items, file);
+        }
+    }
+
+    static void writeCSV(const std::vector<Item>& iItems, std::ostream& oOut)
+    {
+        oOut << "op,type,depth,count,total,max";
+        for (const char* phase : sPhaseNames)
+        {
+            oOut << "," << phase;
+        }
+        oOut << ",slowest\n";
+
+        for (const Item& item : iItems)
+        {
+            const CookStats& stats = item.second;
+
+            oOut << std::get<0>(item.first) << ","
+                 << escapeCSV(std::get<1>(item.first)) << ","
+                 << std::get<2>(item.first) << "," << stats.count << ","
+                 << stats.total << "," << stats.max;
+            for (double phase : stats.phases)
+            {
+                oOut << "," << phase;
+            }
+            oOut << "," << escapeCSV(stats.slowest) << "\n";
+        }
+    }
+
+    static void writeJSON(const std::vector<Item>& iItems, std::ostream& oOut)
+    {
+        oOut << "{ \"unit\": \"seconds\", \"locations\": [";
+
+        for (size_t i = 0; i < iItems.size(); i++)
+        {
+            const Key& key = iItems[i].first;
+            const CookStats& stats = iItems[i].second;
+
+            oOut << (i ? "," : "") << "\n  { \"op\": \"" << std::get<0>(key)
+                 << "\", \"type\": \"" << escapeJSON(std::get<1>(key))
+                 << "\", \"depth\": " << std::get<2>(key)
+                 << ", \"count\": " << stats.count
+                 << ", \"total\": " << stats.total
+                 << ", \"max\": " << stats.max;
+            for (int j = 0; j < CookProfiler::NumPhases; j++)
+            {
+                oOut << ", \"" << sPhaseNames[j] << "\": " << stats.phases[j];
+            }
+            oOut << ", \"slowest\": \"" << escapeJSON(stats.slowest) << "\" }";
+        }
+
+        oOut << "\n] }\n";
+    }
+
+    std::string mFileName;
+    std::mutex mMutex;
+    std::map<Key, CookStats> mStats;
+};
+
+CookRegistry& getCookRegistry()
+{
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#endif
+
+    // The report is written when it's destroyed.
+    static CookRegistry registry;
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+    return registry;
+}
+}
+
+OpUtils::CookProfiler::CookProfiler(const char* iOpType) :
+        mEnabled(isEnabled()),
+        mOpType(iOpType),
+        mDepth(0),
+        mPhase(Other),
+        mParent(nullptr)
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+
+    // The registry reads the name of the report when it's created.
+    getCookRegistry();
+
+    std::fill(mPhases, mPhases + NumPhases, 0.0);
+    mStart = Clock::now();
+    mPhaseStart = mStart;
+
+    mParent = tCurrent;
+    tCurrent = this;
+}
+
+OpUtils::CookProfiler::~CookProfiler()
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+
+    switchPhase(Other);
+    tCurrent = mParent;
+
+    const double total =
+        std::chrono::duration<double>(mPhaseStart - mStart).count();
+
+    getCookRegistry().add(mOpType, mType, mPath, mDepth, total, mPhases);
+}
+
+void OpUtils::CookProfiler::setLocation(
+    const std::string& iType,
+    const std::string& iPath,
+    size_t iDepth)
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+
+    mType = iType;
+    mPath = iPath;
+    mDepth = iDepth;
+}
+
+bool OpUtils::CookProfiler::isEnabled()
+{
+    static const bool enabled = !TfGetEnvSetting(WALTER_COOK_PROFILE).empty();
+    return enabled;
+}
+
+OpUtils::CookProfiler::Phase OpUtils::CookProfiler::switchPhase(Phase iPhase)
+{
+    const Clock::time_point now = Clock::now();
+    mPhases[mPhase] += std::chrono::duration<double>(now - mPhaseStart).count();
+    mPhaseStart = now;
+
+    const Phase previous = mPhase;
+    mPhase = iPhase;
+    return previous;
+}
+
+OpUtils::CookProfiler::Scope::Scope(Phase iPhase) :
+        mProfiler(tCurrent),
+        mPrevious(Other)
+{
+    if (mProfiler)
+    {
+        mPrevious = mProfiler->switchPhase(iPhase);
+    }
+}
+
+OpUtils::CookProfiler::Scope::~Scope()
+{
+    if (mProfiler)
+    {
+        mProfiler->switchPhase(mPrevious);
+    }
+}
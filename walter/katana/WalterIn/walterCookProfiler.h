@@ -0,0 +1,101 @@
+// Copyright 2017 Rodeo FX.  All rights reserved.
+
+#ifndef __WALTERCOOKPROFILER_H_
+#define __WALTERCOOKPROFILER_H_
+
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <string>
+
+namespace OpUtils
+{
+/**
+ * @brief Records the time spent to cook a single Katana location. It's enabled
+ * with WALTER_COOK_PROFILE, which is the file to write the report to. The
+ * report is written when the process exits. It's CSV if the file ends with
+ * ".csv" and JSON otherwise. The locations are aggregated by the op, the type
+ * and the depth, so it's easy to find the assets that dominate the expansion
+ * of the scene graph.
+ *
+ * The object should be created on the stack at the beginning of the cook. The
+ * time of the cook is split with CookProfiler::Scope, which can be used in any
+ * function called by the cook because the current location is kept per thread.
+ */
+class CookProfiler : private boost::noncopyable
+{
+public:
+    /** @brief The parts of the cook. The time that is not in any scope is
+     * Other. */
+    enum Phase
+    {
+        Stage,
+        Geometry,
+        Primvars,
+        Assignments,
+        Attributes,
+        Other,
+        NumPhases
+    };
+
+    /**
+     * @brief Starts recording the cook of the current location.
+     *
+     * @param iOpType The name of the op for the report. It should be a static
+     * string.
+     */
+    explicit CookProfiler(const char* iOpType);
+    ~CookProfiler();
+
+    /**
+     * @brief Sets the information about the location for the report.
+     *
+     * @param iType The type of the prim or the schema of the Alembic object.
+     * @param iPath The path of the prim or the full name of the Alembic object.
+     * @param iDepth The number of the elements in the path.
+     */
+    void setLocation(
+        const std::string& iType,
+        const std::string& iPath,
+        size_t iDepth);
+
+    /** @brief True if WALTER_COOK_PROFILE is set. */
+    static bool isEnabled();
+
+    /** @brief Accounts the time to the given phase until it's destroyed. The
+     * scopes can be nested, the time is accounted to the innermost one. It does
+     * nothing if there is no profiled location in the current thread. */
+    class Scope : private boost::noncopyable
+    {
+    public:
+        explicit Scope(Phase iPhase);
+        ~Scope();
+
+    private:
+        CookProfiler* mProfiler;
+        Phase mPrevious;
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Accounts the time since the last switch to the current phase and starts
+    // the new one. Returns the previous phase.
+    Phase switchPhase(Phase iPhase);
+
+    bool mEnabled;
+    const char* mOpType;
+    std::string mType;
+    std::string mPath;
+    size_t mDepth;
+
+    Clock::time_point mStart;
+    Clock::time_point mPhaseStart;
+    Phase mPhase;
+    double mPhases[NumPhases];
+
+    // The location that was profiled in this thread before this one.
+    CookProfiler* mParent;
+};
+}
+
+#endif
@@ -2,7 +2,7 @@
 
 #include "walterUSDExtern.h"
 #include "walterUSDCommonUtils.h"
-#include "walterUSDOpEngine.h"
+#include <pxr/usd/ar/resolverScopedCache.h>
 #include <boost/algorithm/string.hpp>
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -17,16 +17,29 @@ void WalterUSDExtern::setIdentifier(const char* identifiers)
 
     mIdentifiers.clear();
     boost::split(mIdentifiers, identifiers, boost::is_any_of(":"));
+
+    // We don't use the stage of OpEngine because it's shared with the
+    // locations that are cooked and it's never modified. The UI changes the
+    // variants of its own stage, and the selection is passed to WalterIn as
+    // an argument.
+    ArResolverScopedCache cache;
+    SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(mIdentifiers);
+    mStage = UsdStage::Open(root);
 }
 
 void WalterUSDExtern::extractVariantsUsd()
 {
-    OpEngine& engine = OpEngine::getInstance(mIdentifiers);
+    mFlattenVariants = "";
+    mPrimsCount = 0;
+
+    if (!mStage)
+    {
+        return;
+    }
+
     std::vector<std::string> variants =
-        WalterUSDCommonUtils::getVariantsUSD(
-            engine.getUsdStage(), "", true);
+        WalterUSDCommonUtils::getVariantsUSD(mStage, "", true);
 
-    mFlattenVariants = "";
     mPrimsCount = variants.size();
     for (int i = 0; i < variants.size(); ++i)
     {
@@ -59,8 +72,11 @@ std::string WalterUSDExtern::setVariantUsd(
 
 std::string WalterUSDExtern::setVariantUsd(const char* variants)
 {
-    OpEngine& engine = OpEngine::getInstance(mIdentifiers);
-    WalterUSDCommonUtils::setVariantUSD(engine.getUsdStage(), variants);
+    if (mStage)
+    {
+        WalterUSDCommonUtils::setVariantUSD(mStage, variants);
+    }
+
     return variants;
 }
 
@@ -67,6 +67,9 @@ private:
     int mPrimsCount;
     std::string mFlattenVariants;
     std::vector<std::string> mIdentifiers;
+
+    // The stage of the UI. The variants are set here.
+    UsdStageRefPtr mStage;
 };
 
 #endif
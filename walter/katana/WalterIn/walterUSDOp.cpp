@@ -77,7 +77,15 @@ void cookUSDRoot(
     OpUtils::TimePtr time = std::make_shared<OpUtils::Time>(
         currentTime, shutterOpen, shutterClose, numSamples);
 
-    OpEngine& engine = OpEngine::getInstance(iArchives);
+    // The engine is created for the given variants, so the stage is already
+    // composed when the children are cooked.
+    FnAttribute::StringAttribute variantsListAttr =
+        ioInterface.getOpArg("variantsList");
+    auto variantsSample = variantsListAttr.getNearestSample(currentTime);
+    std::vector<std::string> variantsList(
+        variantsSample.begin(), variantsSample.end());
+
+    OpEngine& engine = OpEngine::getInstance(iArchives, variantsList);
 
     // Att the children PrivateDatas will have this outputLocationPath.
     const OpUtils::PrivateData privateData(
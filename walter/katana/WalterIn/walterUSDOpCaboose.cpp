@@ -3,6 +3,7 @@
 #include "walterUSDOpCaboose.h"
 
 #include "schemas/volume.h"
+#include "walterCookProfiler.h"
 #include "walterUSDOpEngine.h"
 #include "walterUSDOpUtils.h"
 
@@ -10,6 +11,8 @@
 #include <FnAttribute/FnDataBuilder.h>
 #include <FnGeolib/op/FnGeolibOp.h>
 #include <FnGeolibServices/FnXFormUtil.h>
+#include <pxr/base/gf/interval.h>
+#include <pxr/base/gf/traits.h>
 #include <pxr/usd/usdGeom/curves.h>
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdGeom/scope.h>
@@ -20,6 +23,8 @@
 #include <pxr/usd/usdShade/shader.h>
 #include <usdKatana/utils.h>
 #include <boost/algorithm/string.hpp>
+#include <mutex>
+#include <type_traits>
 
 #ifdef USE_OPENVDB
 #include <openvdb/io/File.h>
@@ -44,6 +49,68 @@ void setGroupBuilder(
     groupBuilder->set(iPath, iAttr);
 }
 
+/**
+ * @brief Checks if the value of the attribute is the same during the whole
+ * shutter interval. In this case it's enough to output a single sample to
+ * Katana even if the motion blur is on.
+ *
+ * @param iAttr The attribute to check.
+ * @param iTime The sample times.
+ *
+ * @return True if the attribute is not animated inside the shutter.
+ */
+static bool isStaticInShutter(
+    const UsdAttribute& iAttr,
+    const OpUtils::TimePtr iTime)
+{
+    if (iTime->size() <= 1 || !iAttr.ValueMightBeTimeVarying())
+    {
+        return true;
+    }
+
+    const OpUtils::Time::TimeType open =
+        iTime->current() + iTime->samples().front();
+    const OpUtils::Time::TimeType close =
+        iTime->current() + iTime->samples().back();
+
+    // Any sample inside the shutter changes the value.
+    std::vector<double> times;
+    if (!iAttr.GetTimeSamplesInInterval(GfInterval(open, close), &times) ||
+        !times.empty())
+    {
+        return false;
+    }
+
+    // There are no samples inside the shutter. The value is interpolated
+    // between the samples around it, or it's held if the shutter is before the
+    // first sample or after the last one.
+    double lower;
+    double upper;
+    bool hasTimeSamples;
+    if (!iAttr.GetBracketingTimeSamples(
+            open, &lower, &upper, &hasTimeSamples))
+    {
+        return false;
+    }
+
+    return !hasTimeSamples || lower == upper;
+}
+
+/**
+ * @brief The type of the single component of the USD type. It's float for
+ * GfVec3f and int for int.
+ */
+template <typename T, typename Enable = void> struct ScalarType
+{
+    typedef T type;
+};
+
+template <typename T>
+struct ScalarType<T, typename std::enable_if<GfIsGfVec<T>::value>::type>
+{
+    typedef typename T::ScalarType type;
+};
+
 /**
  * @brief Push USD array attribute to Katana. It extracts data from USD
  * attribute, converts the USD data type to the type understandable by Katana,
@@ -75,16 +142,30 @@ size_t attributeArrayToKatana(
         return 0;
     }
 
+    // The static data is output with a single sample. The value is the same
+    // everywhere inside the shutter, so it's read at the shutter open. The
+    // frame itself can be outside of the shutter.
+    const OpUtils::Time::TimeRange staticSamples(1, iTime->samples().front());
+    const bool isStatic = isStaticInShutter(iAttr, iTime);
+    const OpUtils::Time::TimeRange& samples =
+        isStatic ? staticSamples : iTime->samples();
+
     // Number of motion keys.
-    size_t keys = iTime->size();
+    size_t keys = samples.size();
     // The number of data items.
     size_t size = 0;
 
+    typedef typename KatanaType::value_type KatanaValue;
+    typedef typename ScalarType<UsdType>::type UsdValue;
+    static_assert(
+        sizeof(UsdType) == sizeof(UsdValue) * TupleSize,
+        "The USD type doesn't match the tuple size");
+
     // The data builder to combine animation samples. If there are no samples,
     // it's not used.
     FnAttribute::DataBuilder<KatanaType> dataBuilder;
 
-    for (auto time : iTime->samples())
+    for (auto time : samples)
     {
         VtArray<UsdType> array;
         iAttr.Get(&array, iTime->current() + time);
@@ -94,27 +175,36 @@ size_t attributeArrayToKatana(
             continue;
         }
 
-        // TODO: std::is_same<typename KatanaType::value_type, UsdType>::value
-        std::vector<typename KatanaType::value_type> value;
-
-        // TODO: It will not cast the type. If KatanaType and UsdType are
-        // different, it will produce wrong data.
         size = array.size() * TupleSize;
-        auto dataBegin =
-            reinterpret_cast<typename KatanaType::value_type*>(array.data());
-        auto dataEnd = dataBegin + size;
 
-        value.reserve(size);
-        value.insert(value.end(), dataBegin, dataEnd);
+        // The const access doesn't detach the array from the data of the layer.
+        const VtArray<UsdType>& constArray = array;
+        const UsdValue* dataBegin =
+            reinterpret_cast<const UsdValue*>(constArray.data());
+        const UsdValue* dataEnd = dataBegin + size;
 
-        if (keys == 1)
+        if (keys == 1 && std::is_same<KatanaValue, UsdValue>::value)
         {
+            // Katana copies the data, so we can pass the USD buffer directly.
             oStaticGb.set(
-                iName, KatanaType(&(value.front()), value.size(), TupleSize));
+                iName,
+                KatanaType(
+                    reinterpret_cast<const KatanaValue*>(dataBegin),
+                    size,
+                    TupleSize));
+        }
+        else if (keys == 1)
+        {
+            // The types are different. The elements are converted one by one.
+            std::vector<KatanaValue> value(dataBegin, dataEnd);
+            oStaticGb.set(
+                iName, KatanaType(value.data(), value.size(), TupleSize));
         }
         else
         {
-            dataBuilder.set(value, time);
+            // Fill the sample of the data builder in place.
+            std::vector<KatanaValue>& value = dataBuilder.get(time);
+            value.assign(dataBegin, dataEnd);
         }
     }
 
@@ -369,6 +459,7 @@ FnAttribute::Attribute convertVtValueToArbitrary(
  * @brief Output the bound to the Katana group builder.
  *
  * @param iImageable The UsdGeomImageable with a bound.
+ * @param iEngine The engine that caches the bounds.
  * @param iTime The sample times.
  * @param oStaticGb Output group builder where the new attribute will be
  * created.
@@ -377,6 +468,7 @@ FnAttribute::Attribute convertVtValueToArbitrary(
  */
 void createBound(
     const UsdGeomImageable& iImageable,
+    OpEngine& iEngine,
     const OpUtils::TimePtr iTime,
     FnAttribute::GroupBuilder& oStaticGb,
     bool isLocal=false)
@@ -388,11 +480,8 @@ void createBound(
     bool bboxInitialized = false;
     for (auto t : iTime->samples())
     {
-        GfBBox3d current =  isLocal
-            ? iImageable.ComputeLocalBound(
-                t, UsdGeomTokens->default_, UsdGeomTokens->render)
-            : iImageable.ComputeUntransformedBound(
-                t, UsdGeomTokens->default_, UsdGeomTokens->render);
+        GfBBox3d current = iEngine.computeBound(
+            iImageable.GetPrim(), iTime->current() + t, isLocal);
 
         if (bboxInitialized)
         {
@@ -568,16 +657,25 @@ void cookGeomXformable(
     // For each xform op, construct a matrix containing the
     // transformation data for each time sample it has.
     int opCount = 0;
+    const OpUtils::Time::TimeRange staticSamples(1, iTime->samples().front());
     for (const auto& xformOp : orderedXformOps)
     {
+        // The static ops are output with a single sample at 0. The value is
+        // the same everywhere inside the shutter, so it's read at the shutter
+        // open.
+        const bool isStatic = isStaticInShutter(xformOp.GetAttr(), iTime);
+        const OpUtils::Time::TimeRange& samples =
+            isStatic ? staticSamples : iTime->samples();
+
         FnAttribute::DoubleBuilder matBuilder(16);
-        for (auto time : iTime->samples())
+        for (auto time : samples)
         {
             GfMatrix4d mat = xformOp.GetOpTransform(iTime->current() + time);
 
             // Convert to vector.
             const double* matArray = mat.GetArray();
-            std::vector<double>& matVec = matBuilder.get(time);
+            std::vector<double>& matVec =
+                matBuilder.get(isStatic ? (OpUtils::Time::TimeType)0 : time);
 
             matVec.resize(16);
             for (int i = 0; i < 16; ++i)
@@ -1078,12 +1176,9 @@ void cookWalterVolume(
     // should be fast.
     if (!filename.empty())
     {
-        static std::atomic_bool sIsInitialized(false);
-        if (!sIsInitialized.load())
-        {
-            openvdb::initialize();
-            sIsInitialized = true;
-        }
+        // The locations are cooked concurrently.
+        static std::once_flag sIsInitialized;
+        std::call_once(sIsInitialized, []() { openvdb::initialize(); });
 
         // Trying to open OpenVDB to get the information about bounding box.
         std::unique_ptr<openvdb::io::File> vdb(new openvdb::io::File(filename));
@@ -1128,12 +1223,13 @@ void cookWalterVolume(
 
 void cookInstance(
     const UsdPrim& iPrim,
+    OpEngine& iEngine,
     const OpUtils::TimePtr iTime,
     FnAttribute::GroupBuilder& oStaticGb,
     std::string instanceSourceLocation)
 {
     OpCabooseImpl::createBound(
-        UsdGeomImageable{iPrim}, iTime, oStaticGb, false/*isLocal*/);
+        UsdGeomImageable{iPrim}, iEngine, iTime, oStaticGb, false/*isLocal*/);
 
     oStaticGb.set("type", FnAttribute::StringAttribute("instance"));
     oStaticGb.set(
@@ -1144,12 +1240,12 @@ void cookInstance(
 
 void cookAsRendererProcedural(
     const UsdPrim& iPrim,
+    OpEngine& iEngine,
     const OpUtils::TimePtr iTime,
-    FnAttribute::GroupBuilder& oStaticGb,
-    std::string engineIdentifier)
+    FnAttribute::GroupBuilder& oStaticGb)
 {
     OpCabooseImpl::createBound(
-        UsdGeomImageable{iPrim}, iTime, oStaticGb, true/*isLocal*/);
+        UsdGeomImageable{iPrim}, iEngine, iTime, oStaticGb, true/*isLocal*/);
 
     oStaticGb.set(
         "type", FnAttribute::StringAttribute("renderer procedural"));
@@ -1160,7 +1256,7 @@ void cookAsRendererProcedural(
         "rendererProcedural.node", FnAttribute::StringAttribute("walter"));
     oStaticGb.set(
         "rendererProcedural.args.filePaths",
-        FnAttribute::StringAttribute(engineIdentifier));
+        FnAttribute::StringAttribute(iEngine.getIdentifier()));
     oStaticGb.set(
         "rendererProcedural.args.objectPath",
         FnAttribute::StringAttribute(iPrim.GetPath().GetString()));
@@ -1234,15 +1330,26 @@ void OpCaboose::cook(
 
     FnAttribute::GroupBuilder staticBld;
 
+    // Everything that is not in the nested scopes is the conversion of the
+    // geometry.
+    OpUtils::CookProfiler::Scope geometryScope(OpUtils::CookProfiler::Geometry);
+
     if (iPrim.IsA<UsdGeomImageable>() && iPrim.GetName() != "materials")
     {
         UsdGeomImageable imageable(iPrim);
-        if(imageable.ComputeVisibility() == TfToken("invisible"))
         {
-            return;
+            OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Stage);
+            if(imageable.ComputeVisibility() == TfToken("invisible"))
+            {
+                return;
+            }
         }
 
-        OpCabooseImpl::cookGeomImageable(iPrim, time, staticBld);
+        {
+            OpUtils::CookProfiler::Scope scope(
+                OpUtils::CookProfiler::Primvars);
+            OpCabooseImpl::cookGeomImageable(iPrim, time, staticBld);
+        }
 
         // Cook Walter Assignment only for primitives that are not instances and
         // not a group of instances.
@@ -1251,6 +1358,8 @@ void OpCaboose::cook(
         UsdPrimSiblingRange children = iPrim.GetChildren();
         if (!isInstance && (children.empty() || !children.front().IsInstance()))
         {
+            OpUtils::CookProfiler::Scope scope(
+                OpUtils::CookProfiler::Assignments);
             OpCabooseImpl::cookWalterAssignment(
                 iPrim,
                 iPrivateData,
@@ -1288,9 +1397,9 @@ void OpCaboose::cook(
     {
         OpCabooseImpl::cookAsRendererProcedural(
             iPrim,
+            iPrivateData->engine(),
             time,
-            staticBld,
-            iPrivateData->engine().getIdentifier()
+            staticBld
         );
     }
     else if (isInstance)
@@ -1314,6 +1423,7 @@ void OpCaboose::cook(
             OpCabooseImpl::cookGeomXformable(iPrim, time, staticBld);
             OpCabooseImpl::cookInstance(
                 iPrim,
+                iPrivateData->engine(),
                 time,
                 staticBld,
                 katMasterLocation
@@ -1325,9 +1435,9 @@ void OpCaboose::cook(
         {
             OpCabooseImpl::cookAsRendererProcedural(
                 iPrim,
+                iPrivateData->engine(),
                 time,
-                staticBld,
-                iPrivateData->engine().getIdentifier()
+                staticBld
             );
         }
     }
@@ -1341,6 +1451,9 @@ void OpCaboose::cook(
         staticBld.set("type", FnAttribute::StringAttribute("group"));
     }
 
+    OpUtils::CookProfiler::Scope attributesScope(
+        OpUtils::CookProfiler::Attributes);
+
     OpCabooseImpl::setAllAttrs(*interface, staticBld.build());
 
     // Check if we need to set Arnold defaults.
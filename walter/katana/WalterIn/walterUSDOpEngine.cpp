@@ -1,10 +1,12 @@
 #include "walterUSDOpEngine.h"
 
+#include "walterCookProfiler.h"
 #include "walterUSDOpCaboose.h"
 #include "walterUSDOpDelegate.h"
 #include "walterUSDOpUtils.h"
 #include <FnGeolib/op/FnGeolibOp.h>
 #include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/usd/ar/resolverScopedCache.h>
 #include <pxr/usd/usd/stage.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/functional/hash.hpp>
@@ -33,16 +35,21 @@ public:
      * @brief Returns the engine.
      *
      * @param iArchives the list of archives.
+     * @param iVariants the list of the variant selections.
      *
      * @return The engine.
      */
-    OpEngine& getEngine(const std::vector<std::string>& iArchives)
+    OpEngine& getEngine(
+        const std::vector<std::string>& iArchives,
+        const std::vector<std::string>& iVariants)
     {
         // It's possible to request the engine at the same time.
         ScopedLock lock(mMutex);
 
-        // Get the hash of the archives.
+        // Get the hash of the archives and the variants.
         size_t hash = boost::hash_range(iArchives.begin(), iArchives.end());
+        boost::hash_combine(
+            hash, boost::hash_range(iVariants.begin(), iVariants.end()));
 
         auto it = mCache.find(hash);
         if (it == mCache.end())
@@ -50,7 +57,7 @@ public:
             auto result = mCache.emplace(
                 std::piecewise_construct,
                 std::forward_as_tuple(hash),
-                std::forward_as_tuple(iArchives));
+                std::forward_as_tuple(iArchives, iVariants));
             it = result.first;
         }
 
@@ -70,42 +77,49 @@ private:
 
 TF_INSTANTIATE_SINGLETON(EngineRegistry);
 
-OpEngine& OpEngine::getInstance(const std::vector<std::string>& iArchives)
+OpEngine& OpEngine::getInstance(
+    const std::vector<std::string>& iArchives,
+    const std::vector<std::string>& iVariants)
 {
-    return EngineRegistry::getInstance().getEngine(iArchives);
+    return EngineRegistry::getInstance().getEngine(iArchives, iVariants);
 }
 
 void OpEngine::clearCaches()
 {
     EngineRegistry::getInstance().clear();
+
+    // Katana flushes the caches when the files are changed. Resolve them again.
+    WalterUSDCommonUtils::clearResolverCache();
 }
 
-OpEngine::OpEngine(const std::vector<std::string>& iArchives) :
+OpEngine::OpEngine(
+    const std::vector<std::string>& iArchives,
+    const std::vector<std::string>& iVariants) :
         mIdentifier(boost::algorithm::join(iArchives, ":"))
 {
+    // Resolve the layers once while the stage is opening.
+    ArResolverScopedCache cache;
+
     SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(iArchives);
     mStage = UsdStage::Open(root);
 
-    OpDelegate::populate(mStage->GetPseudoRoot(), mIndex);
-}
-
-void OpEngine::dress(void* ioClientData)
-{
-    auto interface =
-        reinterpret_cast<Foundry::Katana::GeolibCookInterface*>(ioClientData);
-
-    static std::string currentTimeStr = "system.timeSlice.currentTime";
-    FnAttribute::FloatAttribute currentTimeAttr(
-        interface->getOpArg(currentTimeStr));
-
-    float currentTime = currentTimeAttr.getValue(0.0, false);
+    // The variants can change the composition, so they should be applied
+    // before populating the index.
+    for (const std::string& variants : iVariants)
+    {
+        WalterUSDCommonUtils::setVariantUSD(mStage, variants.c_str());
+    }
 
-    FnAttribute::StringAttribute variantsListAttr =
-        interface->getOpArg("variantsList");
+    OpDelegate::populate(mStage->GetPseudoRoot(), mIndex);
 
-    auto variantsList = variantsListAttr.getNearestSample(currentTime);
-    for (auto const* variants : variantsList)
-        WalterUSDCommonUtils::setVariantUSD(mStage, variants);
+    // The stage is not modified after this point, so we can compute the
+    // masters once.
+    mMastersInfoMap = WalterUSDCommonUtils::getMastersInfo(mStage);
+    for (const auto& master : mMastersInfoMap)
+    {
+        mKatMasterNames.emplace(
+            master.first, computeKatMasterName(master.second));
+    }
 }
 
 void OpEngine::cook(
@@ -114,9 +128,21 @@ void OpEngine::cook(
 {
     assert(iPrivateData);
 
-    dress(ioClientData);
+    OpUtils::CookProfiler profiler("WalterInUSD");
 
-    const UsdPrim prim = mStage->GetPrimAtPath(iPrivateData->path());
+    UsdPrim prim;
+    {
+        OpUtils::CookProfiler::Scope scope(OpUtils::CookProfiler::Stage);
+        prim = mStage->GetPrimAtPath(iPrivateData->path());
+    }
+
+    if (prim && OpUtils::CookProfiler::isEnabled())
+    {
+        profiler.setLocation(
+            prim.GetTypeName().GetString(),
+            prim.GetPath().GetString(),
+            prim.GetPath().GetPathElementCount());
+    }
 
     // Output geo. For example polymesh.
     OpCaboose::cook(prim, iPrivateData, ioClientData);
@@ -146,8 +172,6 @@ void OpEngine::cookMasters(
 {
     assert(iPrivateData);
 
-    mMastersInfoMap = WalterUSDCommonUtils::getMastersInfo(mStage);
-
     for (const auto& master: mStage->GetMasters())
     {
         if (OpCaboose::isSupported(master))
@@ -186,14 +210,18 @@ std::string OpEngine::getMasterName(const UsdPrim& iPrim)
 
 std::string OpEngine::getKatMasterName(const UsdPrim& iMasterPrim)
 {
-    WalterUSDCommonUtils::MasterPrimInfo masterInfo =
-        mMastersInfoMap.at(iMasterPrim.GetName());
+    return mKatMasterNames.at(iMasterPrim.GetName());
+}
 
-    if (masterInfo.isEmpty())
+std::string OpEngine::computeKatMasterName(
+    const WalterUSDCommonUtils::MasterPrimInfo& iMasterInfo)
+{
+    if (iMasterInfo.realName.empty())
         return "";
 
-    std::string katanaName = "master_" + masterInfo.realName;
-    std::vector<std::string> variantsSelection = masterInfo.variantsSelection;
+    std::string katanaName = "master_" + iMasterInfo.realName;
+    const std::vector<std::string>& variantsSelection =
+        iMasterInfo.variantsSelection;
 
     for (int i = variantsSelection.size(); i--;)
     {
@@ -202,3 +230,56 @@ std::string OpEngine::getKatMasterName(const UsdPrim& iMasterPrim)
 
     return katanaName;
 }
+
+GfBBox3d OpEngine::computeBound(
+    const UsdPrim& iPrim,
+    double iTime,
+    bool iIsLocal)
+{
+    // The number of the frames to keep the bounds when the time is changed.
+    static const size_t maxCaches = 16;
+
+    BBoxCachePtr bboxCache;
+
+    {
+        std::lock_guard<std::mutex> lock(mBBoxCachesMutex);
+
+        auto it = mBBoxCaches.find(iTime);
+        if (it == mBBoxCaches.end())
+        {
+            // Release the least recently used time only, the other times can
+            // still be cooked.
+            if (mBBoxCaches.size() >= maxCaches)
+            {
+                mBBoxCaches.erase(mBBoxCacheUsage.back());
+                mBBoxCacheUsage.pop_back();
+            }
+
+            // Each thread copies this cache when it needs it for the first
+            // time.
+            const UsdGeomBBoxCache exemplar(
+                UsdTimeCode(iTime),
+                {UsdGeomTokens->default_, UsdGeomTokens->render});
+
+            mBBoxCacheUsage.push_front(iTime);
+            it = mBBoxCaches
+                     .emplace(
+                         iTime,
+                         BBoxCacheEntry{std::make_shared<BBoxCache>(exemplar),
+                                        mBBoxCacheUsage.begin()})
+                     .first;
+        }
+        else
+        {
+            // Move the time to the front of the usage list.
+            mBBoxCacheUsage.splice(
+                mBBoxCacheUsage.begin(), mBBoxCacheUsage, it->second.usage);
+        }
+
+        bboxCache = it->second.cache;
+    }
+
+    UsdGeomBBoxCache& cache = bboxCache->local();
+    return iIsLocal ? cache.ComputeLocalBound(iPrim)
+                    : cache.ComputeUntransformedBound(iPrim);
+}
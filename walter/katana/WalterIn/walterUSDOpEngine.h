@@ -8,6 +8,12 @@
 
 #include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/bboxCache.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
@@ -22,13 +28,19 @@ class OpEngine
 {
 public:
     /**
-     * @brief Public constructor
+     * @brief Public constructor. There is one engine per set of archives and
+     * variants, so the variants are applied only once when the stage is opened
+     * and cooking the locations doesn't modify the stage.
      *
      * @param iArchives the list of archives.
+     * @param iVariants the list of the variant selections in the form
+     * primPath{variantSetName=variantName}.
      *
      * @return The engine.
      */
-    static OpEngine& getInstance(const std::vector<std::string>& iArchives);
+    static OpEngine& getInstance(
+        const std::vector<std::string>& iArchives,
+        const std::vector<std::string>& iVariants = {});
 
     /** @brief Remove all the cached OpEngine objects */
     static void clearCaches();
@@ -57,16 +69,6 @@ public:
         const OpUtils::PrivateData* iPrivateData,
         void* ioClientData);
 
-    /**
-     * @brief Sets scenes parameters before cooking.
-     *
-     * @param iPrivateData The object that is generated by us for each node we
-     * are going to produce.
-     * @param ioClientData The data came from the client (Katana) that should be
-     * passed to the caboose. For Katana it's GeolibCookInterface.
-     */
-    void dress(void* ioClientData);
-
     OpIndex& index() { return mIndex; }
 
     /**
@@ -94,33 +96,75 @@ public:
     const std::string& getIdentifier() const { return mIdentifier; }
 
     /**
-     * @brief Returns the USD stage
+     * @brief Computes the bound of the prim. The bounds are cached per time
+     * and per thread and shared between all the locations cooked by the
+     * thread, so the bounds of the children are not computed again when the
+     * parent is cooked. The caches of the 16 most recently used times are
+     * kept, when a new time comes the least recently used one is released.
+     *
+     * @param iPrim The prim to compute the bound.
+     * @param iTime The time.
+     * @param iIsLocal Whether to return the local bound or the untransformed
+     * bound.
+     *
+     * @return The bound.
      */
-    UsdStageRefPtr getUsdStage() const { return mStage; }
-
+    GfBBox3d computeBound(const UsdPrim& iPrim, double iTime, bool iIsLocal);
 
 private:
     friend class std::pair<const size_t, OpEngine>;
 
     // We need to be sure that this object can be created only by the registry.
-    OpEngine(const std::vector<std::string>& iArchives);
+    OpEngine(
+        const std::vector<std::string>& iArchives,
+        const std::vector<std::string>& iVariants);
 
     WalterUSDCommonUtils::MasterPrimInfo getMasterPrimInfo(
         const UsdPrim& iPrim);
 
+    // Forms the name of the Katana location of the master.
+    static std::string computeKatMasterName(
+        const WalterUSDCommonUtils::MasterPrimInfo& iMasterInfo);
+
     // Material assignments and the index data to fast access.
     OpIndex mIndex;
 
     // We keep the USD stage here, so once engine is destructed, the stage will
-    // be automatically closed.
+    // be automatically closed. It's not modified after the constructor, so the
+    // locations can be cooked concurrently.
     UsdStageRefPtr mStage;
 
     // The string that can be used in the procedural.
     std::string mIdentifier;
 
     // Map master primitive name with the primitive name they refer.
-    // This is used to handle assignement on instances.
+    // This is used to handle assignement on instances. It's computed once in
+    // the constructor, so the stage is not exposed to be sure nobody changes
+    // the variants after that.
     WalterUSDCommonUtils::MastersInfoMap mMastersInfoMap;
+
+    // Map master primitive name with the name of its Katana location.
+    std::unordered_map<std::string, std::string> mKatMasterNames;
+
+    // UsdGeomBBoxCache is not thread safe, so each thread has its own cache
+    // and the threads don't wait for each other. The bounds stay valid
+    // because the stage is not modified after the constructor. When the files
+    // are changed, clearCaches destroys the engine with its caches.
+    typedef tbb::enumerable_thread_specific<UsdGeomBBoxCache> BBoxCache;
+    typedef std::shared_ptr<BBoxCache> BBoxCachePtr;
+
+    // The caches per time and the times from the most recently used to the
+    // least recently used one. The mutex only protects the containers, the
+    // caches in use are kept alive by the threads if they are released.
+    struct BBoxCacheEntry
+    {
+        BBoxCachePtr cache;
+        std::list<double>::iterator usage;
+    };
+
+    std::map<double, BBoxCacheEntry> mBBoxCaches;
+    std::list<double> mBBoxCacheUsage;
+    std::mutex mBBoxCachesMutex;
 };
 
 #endif
@@ -12,30 +12,32 @@ const SdfPath& OpIndex::getMaterialAssignment(
     const SdfPath& objectPath,
     const std::string& target) const
 {
-    ScopedLock lock(mMutex);
     // Getting the necessary target. If it's not exist, we have to create it
     // because we need to cache the result.
-    ObjectToShader& objects = mResolvedAssignments[target];
-
-    // Looking for necessary material. Returns a pair consisting of an iterator
-    // to the inserted element, or the already-existing element if no insertion
-    // happened, and a bool denoting whether the insertion took place. True for
-    // Insertion, False for No Insertion.
-    const auto result = objects.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(objectPath),
-        std::forward_as_tuple());
+    auto targetIt = mResolvedAssignments.find(target);
+    if (targetIt == mResolvedAssignments.end())
+    {
+        targetIt =
+            mResolvedAssignments.insert(std::make_pair(target, ObjectToShader()))
+                .first;
+    }
 
-    SdfPath& assigned = result.first->second;
+    ObjectToShader& objects = targetIt->second;
 
-    if (result.second)
+    // Looking for necessary material.
+    auto it = objects.find(objectPath);
+    if (it != objects.end())
     {
-        // There was no object name in the index. We just created it, so we need
-        // to replace it with the good value.
-        assigned = resolveMaterialAssignment(objectPath.GetString(), target);
+        return it->second;
     }
 
-    return assigned;
+    // There was no object name in the index. It's possible that several
+    // threads resolve the same object at the same time. It's not a problem
+    // because the result is the same, and only the first one is saved.
+    SdfPath assigned =
+        resolveMaterialAssignment(objectPath.GetString(), target);
+
+    return objects.insert(std::make_pair(objectPath, assigned)).first->second;
 }
 
 const OpIndex::NameToAttribute* OpIndex::getAttributes(
@@ -4,6 +4,7 @@
 #define __WALTERUSDOPINDEX_H_
 
 #include <pxr/usd/sdf/path.h>
+#include <tbb/concurrent_unordered_map.h>
 #include <boost/noncopyable.hpp>
 #include "PathUtil.h"
 #include "schemas/expression.h"
@@ -83,8 +84,13 @@ private:
     typedef std::map<WalterCommon::Expression, SdfPath> ExprToMat;
     typedef hashmap<std::string, ExprToMat> Assignments;
 
-    typedef hashmap<SdfPath, SdfPath> ObjectToShader;
-    typedef hashmap<std::string, ObjectToShader> ResolvedAssignments;
+    // The resolved assignments are filled while cooking from several threads.
+    // The elements of the concurrent map are never moved, so it's safe to
+    // return the reference to the value.
+    typedef tbb::concurrent_unordered_map<SdfPath, SdfPath, SdfPath::Hash>
+        ObjectToShader;
+    typedef tbb::concurrent_unordered_map<std::string, ObjectToShader>
+        ResolvedAssignments;
 
     typedef hashmap<SdfPath, NameToAttribute> Attributes;
     /**
@@ -122,17 +128,11 @@ private:
         const std::string& iAttributeName,
         const OpCaboose::ClientAttributePtr& iAttribute);
 
-
-    typedef std::mutex Mutex;
-    typedef std::lock_guard<Mutex> ScopedLock;
-    mutable Mutex mMutex;
-
     // All the assignments of the cache. We don't need TBB here because we fill
     // it from OpDelegate::populate, when OpEngine is constructed.
     Assignments mAssignments;
 
     // The assignments that was already resolved. We need it for fast access.
-    // TODO: TBB
     mutable ResolvedAssignments mResolvedAssignments;
 
     // Walter Overrides to Attributes
@@ -16,6 +16,7 @@
 #include "walterAssignment.h"
 #include "walterAttributes.h"
 #include "walterThreadingUtils.h"
+#include "walterUSDCommonUtils.h"
 #include "walterUsdUtils.h"
 
 #include <AbcExport.h>
@@ -121,6 +122,8 @@ MSyntax Command::cmdSyntax()
 
     syntax.addFlag("-ja", "-joinAll");
 
+    syntax.addFlag("-crc", "-clearResolverCache");
+
     syntax.addFlag("-hp", "-hydraPlugins");
 
     syntax.addFlag("-j", "-join", MSyntax::kString);
@@ -693,6 +696,13 @@ MStatus Command::doIt(const MArgList& args)
         return MS::kSuccess;
     }
 
+    if (argsDb.isFlagSet("-clearResolverCache"))
+    {
+        // The files are changed on the disk. Resolve them again.
+        WalterUSDCommonUtils::clearResolverCache();
+        return MS::kSuccess;
+    }
+
     if (argsDb.isFlagSet("-join"))
     {
         MString objectName;
@@ -5,6 +5,7 @@
 #include <maya/MFileIO.h>
 #include <maya/MFnDagNode.h>
 #include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/usd/ar/resolverScopedCache.h>
 #include <pxr/usd/sdf/layer.h>
 #include <pxr/usd/usd/stage.h>
 #include <tbb/concurrent_unordered_set.h>
@@ -97,6 +98,9 @@ private:
             shape->onTimeChanged(std::numeric_limits<float>::min());
         }
 
+        // Resolve the layers once while the stage is opening.
+        ArResolverScopedCache cache;
+
         // Root layer
         SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(fileName);
 
@@ -105,14 +109,12 @@ private:
 
         if (!session.empty())
         {
-            char layername[100];
-            // We need a unique name because USD can open the previous layer if
-            // it has the same name.
-            // TODO: make a really unique name using UUID.
-
-            sprintf(layername, "anonymous%i.usda", rand());
-            SdfLayerRefPtr sessionLayer = SdfLayer::CreateAnonymous(layername);
-            if (sessionLayer->ImportFromString(session))
+            // The name is formed from the content, so the same session always
+            // produces the same layer name.
+            SdfLayerRefPtr sessionLayer = SdfLayer::CreateAnonymous(
+                WalterUSDCommonUtils::getContentHash(session) + ".usda");
+            if (WalterUSDCommonUtils::importLayerFromString(
+                    sessionLayer, session))
             {
                 stage = UsdStage::Open(root, sessionLayer);
             }
@@ -338,10 +338,11 @@ std::string constructUSDSessionLayer(MObject obj)
         return {};
     }
 
-    // If we don't need assignments, we are done. Return what we have.
-    std::string session;
-    sceneStage->GetSessionLayer()->ExportToString(&session);
-    return session;
+    // If we don't need assignments, we are done. Return what we have. The
+    // session layer can contain the animated transforms, so it's saved in the
+    // binary form to keep the Maya scene and the ass file small.
+    return WalterUSDCommonUtils::getLayerAsBinary(
+        sceneStage->GetSessionLayer());
 }
 
 std::string getVariantsLayerAsText(MObject obj)
@@ -437,7 +438,8 @@ void setUSDSessionLayer(MObject obj, const std::string& session)
         sceneStage->GetSessionLayer()->Clear();
     }
 
-    else if (!sceneStage->GetSessionLayer()->ImportFromString(session))
+    else if (!WalterUSDCommonUtils::importLayerFromString(
+                 sceneStage->GetSessionLayer(), session))
     {
         MGlobal::displayError(
             "[Walter USD] Cant't set the session layer to the object " +
@@ -564,8 +566,16 @@ bool propertiesUSD(
         return false;
     }
 
+    // The attribute editor shows a preview of the arrays, so the big arrays
+    // are not converted entirely.
+    static const int previewElementCount = 100;
+
     std::vector<std::string> result_ = WalterUSDCommonUtils::propertiesUSD(
-        stage, subNodeName.asChar(), node->time, attributeOnly);
+        stage,
+        subNodeName.asChar(),
+        node->time,
+        attributeOnly,
+        previewElementCount);
     stdStringArrayToMStringArray(result_, result);
 
     return true;
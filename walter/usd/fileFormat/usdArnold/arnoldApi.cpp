@@ -3,6 +3,10 @@
 #include "arnoldApi.h"
 
 #include <dlfcn.h>
+#include <link.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <sstream>
 
 static const char* sLibAi = "libai.so";
 
@@ -24,8 +28,9 @@ ArnoldAPI::ArnoldAPI() : mArnoldDSO(dlopen(sLibAi, RTLD_NOW))
     INIT_AI_SYMBOL(AiGetVersion);
     // Save the version
     char arch[16];
-    AiGetVersion(arch, nullptr, nullptr, nullptr);
+    const char* version = AiGetVersion(arch, nullptr, nullptr, nullptr);
     mArch = atoi(arch);
+    mVersion = version ? version : "";
 
     // Load the symbols
     INIT_AI_SYMBOL(AiASSLoad);
@@ -83,6 +88,50 @@ ArnoldAPIPtr ArnoldAPI::create()
     return ArnoldAPIPtr();
 }
 
+std::string ArnoldAPI::GetLibraryPath()
+{
+    // If Arnold is already loaded, ask the loader where it's from.
+    void* dso = dlopen(sLibAi, RTLD_LAZY | RTLD_NOLOAD);
+    if (dso)
+    {
+        std::string path;
+        struct link_map* linkMap = nullptr;
+        if (dlinfo(dso, RTLD_DI_LINKMAP, &linkMap) == 0 && linkMap &&
+            linkMap->l_name)
+        {
+            path = linkMap->l_name;
+        }
+
+        dlclose(dso);
+        return path;
+    }
+
+    // Otherwise, look for it where dlopen looks first.
+    const char* libraryPath = getenv("LD_LIBRARY_PATH");
+    if (!libraryPath)
+    {
+        return {};
+    }
+
+    std::istringstream directories(libraryPath);
+    std::string directory;
+    while (std::getline(directories, directory, ':'))
+    {
+        if (directory.empty())
+        {
+            continue;
+        }
+
+        std::string path = directory + "/" + sLibAi;
+        if (access(path.c_str(), R_OK) == 0)
+        {
+            return path;
+        }
+    }
+
+    return {};
+}
+
 ArnoldAPI::~ArnoldAPI()
 {
     if (mArnoldDSO)
@@ -5,6 +5,7 @@
 
 #include <ai.h>
 #include <memory>
+#include <string>
 
 class ArnoldAPI;
 typedef std::shared_ptr<ArnoldAPI> ArnoldAPIPtr;
@@ -14,11 +15,18 @@ class ArnoldAPI
 public:
     static ArnoldAPIPtr create();
 
+    // The full path of libai that is loaded or would be loaded by create().
+    // It doesn't load Arnold. Empty if it's not found.
+    static std::string GetLibraryPath();
+
     ArnoldAPI();
     ~ArnoldAPI();
 
     int GetArchVersion() const { return valid() ? mArch : -1; }
 
+    // The full version of Arnold like "5.0.2.0".
+    const std::string& GetVersion() const { return mVersion; }
+
     bool valid() const;
 
     typedef int (*AiASSLoadFuncPtr)(const char* filename, int mask);
@@ -157,6 +165,7 @@ private:
 
     // The Arnold version
     int mArch;
+    std::string mVersion;
 };
 
 #endif
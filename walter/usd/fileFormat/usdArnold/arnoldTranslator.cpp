@@ -4,8 +4,14 @@
 
 #include "arnoldApi.h"
 #include "schemas/volume.h"
+#include "walterUSDCommonUtils.h"
 
+#include <pxr/base/arch/fileSystem.h>
 #include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/stringUtils.h>
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usdShade/connectableAPI.h>
 #include <pxr/usd/usdShade/material.h>
@@ -15,11 +21,34 @@
 #include <boost/preprocessor/cat.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/range/algorithm/replace_copy_if.hpp>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <unordered_set>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+TF_DEFINE_ENV_SETTING(
+    WALTER_USDARNOLD_CACHE,
+    true,
+    "Save the ass files translated to USD to the disk and reuse them.");
+
+TF_DEFINE_ENV_SETTING(
+    WALTER_USDARNOLD_CACHE_DIR,
+    "",
+    "The directory of the translated ass files. If it's empty, a directory of "
+    "the current user in the temporary directory is used.");
+
 namespace ArnoldUSDTranslatorImpl
 {
+// It's a part of the key of the cache. It should be incremented when the
+// translation is changed, so the files translated before are not used.
+static const int sTranslatorVersion = 2;
+
 static const TfToken sOut("out");
 
 // TODO:
@@ -455,78 +484,466 @@ WalterVolume createUSDVolume(
     return volume;
 }
 
+/** @brief A token of the ass file. */
+struct AssToken
+{
+    std::string text;
+    // The strings are quoted. They are never the names of the nodes.
+    bool quoted;
+};
+
+/**
+ * @brief Splits the line of the ass file to the tokens. The comments are
+ * skipped, the quoted strings are returned without quotes and the braces are
+ * always separate tokens.
+ *
+ * @param iLine The line of the ass file.
+ * @param oTokens The tokens.
+ */
+void splitAssLine(const std::string& iLine, std::vector<AssToken>& oTokens)
+{
+    oTokens.clear();
+
+    std::string token;
+    auto flush = [&token, &oTokens]() {
+        if (!token.empty())
+        {
+            oTokens.push_back({token, false});
+            token.clear();
+        }
+    };
+
+    for (size_t i = 0; i < iLine.size(); i++)
+    {
+        const char c = iLine[i];
+        if (c == '#')
+        {
+            // Comment. Skip the rest of the line.
+            break;
+        }
+        else if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            flush();
+        }
+        else if (c == '"')
+        {
+            flush();
+            size_t end = iLine.find('"', i + 1);
+            if (end == std::string::npos)
+            {
+                end = iLine.size();
+            }
+
+            oTokens.push_back({iLine.substr(i + 1, end - i - 1), true});
+            i = end;
+        }
+        else if (c == '{' || c == '}')
+        {
+            flush();
+            oTokens.push_back({std::string(1, c), false});
+        }
+        else
+        {
+            token.push_back(c);
+        }
+    }
+
+    flush();
+}
+
+/**
+ * @brief Checks if the Arnold node type is a shader. Without Arnold we don't
+ * know the type of the node, so we consider that everything that is not a
+ * known built-in node is a shader.
+ *
+ * @param iType The Arnold node type like "standard_surface".
+ *
+ * @return True if it's a shader.
+ */
+bool isShaderType(const std::string& iType)
+{
+    static const std::unordered_set<std::string> nonShaders = {
+        "alembic", "barndoor", "box", "collection", "color_manager_ocio",
+        "color_manager_syncolor", "cone", "curves", "cylinder", "disable",
+        "disk", "ginstance", "gobo", "implicit", "include_graph",
+        "light_blocker", "materialx", "merge", "nurbs", "options", "plane",
+        "points", "polymesh", "procedural", "set_parameter", "set_transform",
+        "sphere", "switch_operator", "usd", "volume", "volume_implicit",
+        "walter", "xgen_procedural"};
+
+    return !nonShaders.count(iType) &&
+           !boost::starts_with(iType, "driver_") &&
+           !boost::starts_with(iType, "imager_") &&
+           !boost::ends_with(iType, "_camera") &&
+           !boost::ends_with(iType, "_filter") &&
+           !boost::ends_with(iType, "_light") &&
+           !boost::ends_with(iType, "_procedural");
+}
+
+/**
+ * @brief Fills the stage with the hierarchy of the ass file without Arnold. It
+ * creates the volumes and the materials with the root shaders, but the
+ * parameters and the shading networks are not translated. The result has the
+ * same prims as fillUSDStage.
+ *
+ * @param ioStage The stage to fill.
+ * @param iFile Full file name of the ass file.
+ *
+ * @return True if the file was read.
+ */
+bool scanUSDStage(UsdStageRefPtr ioStage, const std::string& iFile)
+{
+    std::ifstream stream(iFile);
+    if (!stream)
+    {
+        return false;
+    }
+
+    struct AssNode
+    {
+        std::string type;
+        std::string name;
+        // The values of the shader parameter of the volume.
+        std::vector<std::string> shader;
+        // The unquoted values of the parameters of the shader. The links are
+        // among them.
+        std::vector<std::string> links;
+    };
+
+    std::vector<AssNode> nodes;
+    std::unordered_set<std::string> shaderNames;
+
+    // Each line of the node is a parameter. The first token is the name of the
+    // parameter, the rest are the values.
+    AssNode node;
+    bool hasType = false;
+    bool inNode = false;
+    bool isShader = false;
+    std::string line;
+    std::vector<AssToken> tokens;
+    while (std::getline(stream, line))
+    {
+        splitAssLine(line, tokens);
+
+        std::string param;
+        bool isParamName = true;
+        for (const AssToken& token : tokens)
+        {
+            if (!inNode)
+            {
+                if (hasType && !token.quoted && token.text == "{")
+                {
+                    inNode = true;
+                    isShader = isShaderType(node.type);
+                }
+                else
+                {
+                    node = AssNode();
+                    node.type = token.text;
+                    hasType = true;
+                }
+
+                continue;
+            }
+
+            if (!token.quoted && token.text == "}")
+            {
+                if (!node.name.empty() && (isShader || node.type == "volume"))
+                {
+                    if (isShader)
+                    {
+                        shaderNames.insert(node.name);
+                    }
+
+                    nodes.push_back(std::move(node));
+                }
+
+                node = AssNode();
+                hasType = false;
+                inNode = false;
+                continue;
+            }
+
+            if (isParamName)
+            {
+                param = token.text;
+                isParamName = false;
+            }
+            else if (param == "name")
+            {
+                node.name = token.text;
+            }
+            else if (param == "shader" && node.type == "volume")
+            {
+                node.shader.push_back(token.text);
+            }
+            else if (isShader && !token.quoted)
+            {
+                node.links.push_back(token.text);
+            }
+        }
+    }
+
+    // The shaders that are connected to other shaders are not roots. The link
+    // is the name of the shader, optionally with the component like "tex.r".
+    std::unordered_set<std::string> nodesWithOutput;
+    for (const AssNode& node : nodes)
+    {
+        for (const std::string& value : node.links)
+        {
+            std::string linked = value.substr(0, value.find('.'));
+            if (linked != node.name && shaderNames.count(linked))
+            {
+                nodesWithOutput.insert(linked);
+            }
+        }
+    }
+
+    static const TfToken infoType("info:type");
+    static const TfToken infoTarget("info:target");
+    static const TfToken arnold("arnold");
+
+    for (const AssNode& node : nodes)
+    {
+        SdfPath path(getGoodUSDName(node.name));
+
+        if (node.type == "volume")
+        {
+            WalterVolume volume = WalterVolume::Define(ioStage, path);
+
+            // It's "shader foo" or an array like "shader 1 1 NODE foo". Only
+            // the first shader is used.
+            auto it = std::find(node.shader.begin(), node.shader.end(), "NODE");
+            it = it == node.shader.end() ? node.shader.begin() : it + 1;
+            if (it != node.shader.end())
+            {
+                // Bind material to this prim.
+                UsdRelationship shaderRel = volume.GetPrim().CreateRelationship(
+                    UsdShadeTokens->materialBinding, false);
+                SdfPathVector targets(1, SdfPath(getGoodUSDName(*it)));
+                shaderRel.SetTargets(targets);
+            }
+        }
+        else if (!nodesWithOutput.count(node.name))
+        {
+            UsdShadeMaterial::Define(ioStage, path);
+
+            UsdShadeShader shader = UsdShadeShader::Define(
+                ioStage, path.AppendChild(path.GetNameToken()));
+            UsdPrim prim = shader.GetPrim();
+            prim.CreateAttribute(
+                    infoType,
+                    SdfValueTypeNames->Token,
+                    false,
+                    SdfVariabilityVarying)
+                .Set(TfToken(node.type));
+            prim.CreateAttribute(
+                    infoTarget,
+                    SdfValueTypeNames->Token,
+                    false,
+                    SdfVariabilityVarying)
+                .Set(arnold);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Generates the name of the cached crate file of the given ass file. It
+ * contains the hash of the file name, the modification time, the library of
+ * Arnold with its modification time and the version of the translator, so the
+ * cache is not used when one of them is changed. Arnold is not loaded here, so
+ * the cache can be read without it.
+ *
+ * @param iFile Full file name of the ass file.
+ *
+ * @return The full name of the crate file or an empty string if the cache is
+ * disabled, the library of Arnold is not found or the default directory is not
+ * private.
+ */
+std::string getCacheFileName(const std::string& iFile)
+{
+    if (!TfGetEnvSetting(WALTER_USDARNOLD_CACHE))
+    {
+        return {};
+    }
+
+    double time;
+    if (!ArchGetModificationTime(iFile.c_str(), &time))
+    {
+        return {};
+    }
+
+    const std::string library = ArnoldAPI::GetLibraryPath();
+    double libraryTime;
+    if (library.empty() ||
+        !ArchGetModificationTime(library.c_str(), &libraryTime))
+    {
+        return {};
+    }
+
+    std::string directory = TfGetEnvSetting(WALTER_USDARNOLD_CACHE_DIR);
+    if (directory.empty())
+    {
+        // The temporary directory is shared by all the users. The cache is
+        // private, so nobody else can put there a file we would load.
+        const uid_t uid = getuid();
+        directory = TfStringCatPaths(
+            ArchGetTmpDir(), TfStringPrintf("walterUsdArnold-%d", (int)uid));
+
+        struct stat info;
+        if (stat(directory.c_str(), &info) == 0 &&
+            (!S_ISDIR(info.st_mode) || info.st_uid != uid ||
+             (info.st_mode & (S_IWGRP | S_IWOTH))))
+        {
+            TF_WARN(
+                "[WALTER]: The cache of the ass files is disabled because %s "
+                "is not a private directory of the current user.",
+                directory.c_str());
+            return {};
+        }
+    }
+
+    std::string hash = WalterUSDCommonUtils::getContentHash(
+        {iFile,
+         TfStringPrintf("%.6f", time),
+         library,
+         TfStringPrintf("%.6f", libraryTime),
+         std::to_string(sTranslatorVersion)});
+
+    return TfStringCatPaths(directory, hash + ".usdc");
+}
+
+/**
+ * @brief Fills the layer with the content of the cached crate file.
+ *
+ * @param iCacheFile The full name of the crate file.
+ * @param ioLayer The layer to fill.
+ *
+ * @return True if the cache exists and it was read.
+ */
+bool readCache(const std::string& iCacheFile, SdfLayerRefPtr ioLayer)
+{
+    if (!TfIsFile(iCacheFile))
+    {
+        return false;
+    }
+
+    SdfLayerRefPtr cached = SdfLayer::FindOrOpen(iCacheFile);
+    if (!cached)
+    {
+        return false;
+    }
+
+    ioLayer->TransferContent(cached);
+    return true;
+}
+
+/**
+ * @brief Saves the layer to the crate file. Several processes and threads can
+ * translate the same file at the same time, so the layer is saved to a unique
+ * file first and renamed then.
+ *
+ * @param iCacheFile The full name of the crate file.
+ * @param iLayer The layer to save.
+ */
+void writeCache(const std::string& iCacheFile, SdfLayerRefPtr iLayer)
+{
+    // The directory is created only readable by the current user.
+    std::string directory = TfGetPathName(iCacheFile);
+    if (!TfIsDir(directory) && !TfMakeDirs(directory, 0700))
+    {
+        return;
+    }
+
+    // The file should be in the same directory to be renamed. The counter
+    // makes it unique for the threads of the process.
+    static std::atomic<unsigned> counter(0);
+    std::string tmpFile = TfStringPrintf(
+        "%s.%d.%u.usdc",
+        TfStringGetBeforeSuffix(iCacheFile).c_str(),
+        (int)getpid(),
+        counter++);
+    if (!iLayer->Export(tmpFile))
+    {
+        return;
+    }
+
+    if (rename(tmpFile.c_str(), iCacheFile.c_str()) != 0)
+    {
+        std::remove(tmpFile.c_str());
+    }
+}
+
 bool fillUSDStage(
     UsdStageRefPtr ioStage,
     ArnoldAPIPtr ioAi,
-    const std::string& iFile)
+    const std::string& iFile,
+    bool iIsNewUniverse)
 {
-    // Since it's possible that we didn't create Arnold context, we need to get
-    // the current nodes.
-    std::set<AtNode*> nodesBeforeLoad;
-    AtNodeIterator* nodeIterator = ioAi->AiUniverseGetNodeIterator(AI_NODE_ALL);
+    static const unsigned int mask = AI_NODE_SHAPE | AI_NODE_SHADER;
+
+    // There is no API to get nodes that was loaded with AiASSLoad, so we need
+    // to remember the current nodes to skip them. Even if the universe was
+    // created by us, AiBegin already added the built-in nodes like
+    // ai_default_reflection_shader and ai_bad_shader.
+    std::unordered_set<AtNode*> nodesBeforeLoad;
+    AtNodeIterator* nodeIterator = ioAi->AiUniverseGetNodeIterator(mask);
     while (!ioAi->AiNodeIteratorFinished(nodeIterator))
     {
-        AtNode* node = ioAi->AiNodeIteratorGetNext(nodeIterator);
-        nodesBeforeLoad.insert(node);
+        nodesBeforeLoad.insert(ioAi->AiNodeIteratorGetNext(nodeIterator));
     }
     ioAi->AiNodeIteratorDestroy(nodeIterator);
 
-    if (ioAi->AiASSLoad(iFile.c_str(), AI_NODE_SHAPE | AI_NODE_SHADER) != 0)
+    if (ioAi->AiASSLoad(iFile.c_str(), mask) != 0)
     {
         return false;
     }
 
-    // There is no API to get nodes that was loaded with AiASSLoad. To get them
-    // we need to get all the nodes and find the difference.
-    std::set<AtNode*> nodesAfterLoad;
-    nodeIterator = ioAi->AiUniverseGetNodeIterator(AI_NODE_ALL);
+    // Arnold doesn't have inheritance and all the nodes are flat there. In USD
+    // it's a good practice to group the shading nodes into materials. To do it
+    // we need to know what shaders are "roots". Grouping nodes is a classic
+    // linked list problem, we simplified it a little bit. We visit each loaded
+    // node once, save all the nodes connected to its inputs and output the
+    // nodes with no connection after that.
+    std::vector<AtNode*> newNodes;
+    std::unordered_set<const AtNode*> nodesWithOutput;
+    nodeIterator = ioAi->AiUniverseGetNodeIterator(mask);
     while (!ioAi->AiNodeIteratorFinished(nodeIterator))
     {
         AtNode* node = ioAi->AiNodeIteratorGetNext(nodeIterator);
-        nodesAfterLoad.insert(node);
-    }
-    ioAi->AiNodeIteratorDestroy(nodeIterator);
+        if (nodesBeforeLoad.count(node))
+        {
+            continue;
+        }
 
-    std::set<AtNode*> newNodes;
-    std::set_difference(
-        nodesAfterLoad.begin(),
-        nodesAfterLoad.end(),
-        nodesBeforeLoad.begin(),
-        nodesBeforeLoad.end(),
-        std::inserter(newNodes, newNodes.begin()));
+        newNodes.push_back(node);
 
-    // Arnold doesn't have inheritance and all the nodes are flat there. In USD
-    // it's a good practice to group the shading nodes into materials. To do it
-    // we need to know what shaders are "roots". The following code tries to
-    // recognize it. Grouping nodes is a classic linked list problem, we
-    // simplified it a little bit. We save the connected nodes on the first pass
-    // and output the nodes with no connection on the second pass.
-    std::set<AtNode*> nodesWithOutput;
-    for (const AtNode* node : newNodes)
-    {
         const AtNodeEntry* entry = ioAi->AiNodeGetNodeEntry(node);
-        int type = ioAi->AiNodeEntryGetType(entry);
-
-        if (type == AI_NODE_SHADER)
+        if (ioAi->AiNodeEntryGetType(entry) != AI_NODE_SHADER)
         {
-            AtParamIterator* paramIterator =
-                ioAi->AiNodeEntryGetParamIterator(entry);
+            continue;
+        }
 
-            while (!ioAi->AiParamIteratorFinished(paramIterator))
+        AtParamIterator* paramIterator =
+            ioAi->AiNodeEntryGetParamIterator(entry);
+        while (!ioAi->AiParamIteratorFinished(paramIterator))
+        {
+            const AtParamEntry* paramEntry =
+                ioAi->AiParamIteratorGetNext(paramIterator);
+            AtString paramName = ioAi->AiParamGetName(paramEntry);
+            // It returns nullptr if the parameter is not linked.
+            const AtNode* linked =
+                ioAi->AiNodeGetLink(node, paramName.c_str(), nullptr);
+            if (linked)
             {
-                const AtParamEntry* paramEntry =
-                    ioAi->AiParamIteratorGetNext(paramIterator);
-                AtString paramName = ioAi->AiParamGetName(paramEntry);
-                if (ioAi->AiNodeIsLinked(node, paramName.c_str()))
-                {
-                    nodesWithOutput.insert(
-                        ioAi->AiNodeGetLink(node, paramName.c_str(), nullptr));
-                    break;
-                }
+                nodesWithOutput.insert(linked);
             }
-            ioAi->AiParamIteratorDestroy(paramIterator);
         }
+        ioAi->AiParamIteratorDestroy(paramIterator);
     }
+    ioAi->AiNodeIteratorDestroy(nodeIterator);
 
     // Output the nodes
     for (AtNode* node : newNodes)
@@ -560,25 +977,34 @@ bool fillUSDStage(
     }
 
     // Delete nodes that we just loaded. We don't need them anymore in the
-    // Arnold context.
-    for (AtNode* node : newNodes)
+    // Arnold context. If the universe is ours, AiEnd removes everything.
+    if (!iIsNewUniverse)
     {
-        // AiNodeDestroy crashes. AiNodeReset removes all the parameters and
-        // Arnold will ignore such node which is not bad in our case.
-        ioAi->AiNodeReset(node);
+        for (AtNode* node : newNodes)
+        {
+            // AiNodeDestroy crashes. AiNodeReset removes all the parameters and
+            // Arnold will ignore such node which is not bad in our case.
+            ioAi->AiNodeReset(node);
+        }
     }
 
     return true;
 }
 }
 
-SdfLayerRefPtr ArnoldUSDTranslator::arnoldToUsdLayer(const std::string& iFile)
+SdfLayerRefPtr ArnoldUSDTranslator::arnoldToUsdLayer(
+    const std::string& iFile,
+    bool iMetadataOnly)
 {
     // Create the layer to populate.
     SdfLayerRefPtr layer = SdfLayer::CreateAnonymous(".usda");
 
-    ArnoldAPIPtr ai = ArnoldAPI::create();
-    if (!ai)
+    // Starting Arnold and loading the ass file is slow. If the same file was
+    // already translated with the same Arnold, we just read the result. Arnold
+    // is not loaded for it.
+    std::string cacheFile = ArnoldUSDTranslatorImpl::getCacheFileName(iFile);
+    if (!cacheFile.empty() &&
+        ArnoldUSDTranslatorImpl::readCache(cacheFile, layer))
     {
         return layer;
     }
@@ -587,6 +1013,26 @@ SdfLayerRefPtr ArnoldUSDTranslator::arnoldToUsdLayer(const std::string& iFile)
     UsdStageRefPtr stage = UsdStage::Open(layer);
     stage->SetEditTarget(layer);
 
+    if (iMetadataOnly)
+    {
+        // Only the hierarchy is requested. We don't need Arnold for it. It's
+        // not saved to the cache because it's not complete.
+        ArnoldUSDTranslatorImpl::scanUSDStage(stage, iFile);
+        return layer;
+    }
+
+    ArnoldAPIPtr ai = ArnoldAPI::create();
+    if (!ai)
+    {
+        return layer;
+    }
+
+    if (cacheFile.empty())
+    {
+        // Arnold is loaded now, so the loader knows where the library is.
+        cacheFile = ArnoldUSDTranslatorImpl::getCacheFileName(iFile);
+    }
+
     bool sessionCreated = false;
     if (!ai->AiUniverseIsActive())
     {
@@ -596,13 +1042,19 @@ SdfLayerRefPtr ArnoldUSDTranslator::arnoldToUsdLayer(const std::string& iFile)
     }
 
     // Generate the stage.
-    ArnoldUSDTranslatorImpl::fillUSDStage(stage, ai, iFile);
+    bool filled =
+        ArnoldUSDTranslatorImpl::fillUSDStage(stage, ai, iFile, sessionCreated);
 
     if (sessionCreated)
     {
         ai->AiEnd();
     }
 
+    if (filled && !cacheFile.empty())
+    {
+        ArnoldUSDTranslatorImpl::writeCache(cacheFile, layer);
+    }
+
     return layer;
 }
 
@@ -13,10 +13,14 @@ namespace ArnoldUSDTranslator
      * @brief Convert ass file to SdfLayer.
      *
      * @param iFile Full file name.
+     * @param iMetadataOnly If true, Arnold is not started and only the
+     * hierarchy of the volumes and the materials is generated.
      *
      * @return The pointer to the created layer.
      */
-    SdfLayerRefPtr arnoldToUsdLayer(const std::string& iFile);
+    SdfLayerRefPtr arnoldToUsdLayer(
+        const std::string& iFile,
+        bool iMetadataOnly = false);
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -58,7 +58,8 @@ bool UsdArnoldFileFormat::Read(
     }
 
     // Translate obj to usd schema.
-    SdfLayerRefPtr objAsUsd = ArnoldUSDTranslator::arnoldToUsdLayer(filePath);
+    SdfLayerRefPtr objAsUsd =
+        ArnoldUSDTranslator::arnoldToUsdLayer(filePath, metadataOnly);
     if (!objAsUsd)
     {
         return false;
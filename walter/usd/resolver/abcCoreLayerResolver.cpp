@@ -3,11 +3,15 @@
 #include "abcCoreLayerResolver.h"
 
 #include <boost/algorithm/string.hpp>
+#include <limits>
 #include <pxr/base/arch/fileSystem.h>
 #include <pxr/base/plug/registry.h>
+#include <pxr/base/tf/pathUtils.h>
 #include <pxr/base/tf/type.h>
 #include <pxr/base/vt/value.h>
 #include <pxr/usd/ar/defineResolver.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 #define ABC_CORE_LAYER_SEPARATOR ":"
 
@@ -54,6 +58,27 @@ inline void splitPath(
     }
 }
 
+// Return true if all the archives can be resolved from any thread. The default
+// resolver keeps the bound context per thread, so the relative paths should be
+// resolved in the thread that bound it.
+inline bool canResolveConcurrently(const std::vector<std::string>& archives)
+{
+    if (archives.size() < 2)
+    {
+        return false;
+    }
+
+    for (const std::string& archive : archives)
+    {
+        if (TfIsRelativePath(archive))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 AbcCoreLayerResolver::AbcCoreLayerResolver() :
     ArDefaultResolver()
 {}
@@ -70,21 +95,46 @@ std::string AbcCoreLayerResolver::ResolveWithAssetInfo(
         std::vector<std::string> archives;
         splitPath(path, archives);
 
+        std::vector<std::string> results(archives.size());
+        std::vector<ArAssetInfo> assetInfos(archives.size());
+
+        // Resolve each archive with the default resolver. The archives are
+        // often on the network storage, so we resolve them at the same time.
+        auto resolve = [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i != r.end(); i++)
+            {
+                results[i] =
+                    BaseType::ResolveWithAssetInfo(archives[i], &assetInfos[i]);
+            }
+        };
+
+        tbb::blocked_range<size_t> range(0, archives.size());
+        if (canResolveConcurrently(archives))
+        {
+            tbb::parallel_for(range, resolve);
+        }
+        else
+        {
+            resolve(range);
+        }
+
         std::vector<std::string> resolved;
         resolved.reserve(archives.size());
 
-        // Resolve each archive with the default resolver.
-        for (const std::string& archive : archives)
+        for (size_t i = 0; i < archives.size(); i++)
         {
-            std::string result =
-                BaseType::ResolveWithAssetInfo(archive, assetInfo);
-
-            if (result.empty())
+            if (results[i].empty())
             {
                 continue;
             }
 
-            resolved.push_back(result);
+            resolved.push_back(results[i]);
+
+            // Keep the info of the last resolved archive.
+            if (assetInfo)
+            {
+                *assetInfo = assetInfos[i];
+            }
         }
 
         return boost::join(resolved, ABC_CORE_LAYER_SEPARATOR);
@@ -106,20 +156,24 @@ VtValue AbcCoreLayerResolver::GetModificationTimestamp(
         std::vector<std::string> archives;
         splitPath(resolvedPath, archives);
 
-        std::vector<double> times;
-        times.reserve(archives.size());
-
-        // Look at the time of the each archive.
-        for (const std::string& archive : archives)
-        {
-            double time;
-            if (!ArchGetModificationTime(archive.c_str(), &time))
-            {
-                continue;
-            }
+        // Look at the time of the each archive. The resolved paths are
+        // absolute, so we can stat all of them at the same time. The archives
+        // that can't be stated keep the lowest time.
+        const double noTime = std::numeric_limits<double>::lowest();
+        std::vector<double> times(archives.size(), noTime);
 
-            times.push_back(time);
-        }
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, archives.size()),
+            [&](const tbb::blocked_range<size_t>& r) {
+                for (size_t i = r.begin(); i != r.end(); i++)
+                {
+                    double time;
+                    if (ArchGetModificationTime(archives[i].c_str(), &time))
+                    {
+                        times[i] = time;
+                    }
+                }
+            });
 
         if (times.empty())
         {
@@ -127,6 +181,10 @@ VtValue AbcCoreLayerResolver::GetModificationTimestamp(
         }
 
         double maxTime = *std::max_element(times.begin(), times.end());
+        if (maxTime == noTime)
+        {
+            return VtValue();
+        }
 
         return VtValue(maxTime);
     }
@@ -0,0 +1,83 @@
+// Copyright 2017 Rodeo FX. All rights reserved.
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/relationship.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdShade/tokens.h>
+
+#include "arnoldApi.h"
+#include "arnoldTranslator.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+// The type and the material binding of the root prims of the layer.
+static std::map<std::string, std::string> getHierarchy(SdfLayerRefPtr iLayer)
+{
+    std::map<std::string, std::string> hierarchy;
+
+    UsdStageRefPtr stage = UsdStage::Open(iLayer);
+    for (const UsdPrim& prim : stage->GetPseudoRoot().GetChildren())
+    {
+        std::string description = prim.GetTypeName().GetString();
+
+        UsdRelationship binding =
+            prim.GetRelationship(UsdShadeTokens->materialBinding);
+        SdfPathVector targets;
+        if (binding && binding.GetTargets(&targets))
+        {
+            for (const SdfPath& target : targets)
+            {
+                description += " " + target.GetString();
+            }
+        }
+
+        hierarchy[prim.GetPath().GetString()] = description;
+    }
+
+    return hierarchy;
+}
+
+TEST(arnoldToUsdLayer, metadataOnlyMatchesFull)
+{
+    // The metadata-only mode doesn't need Arnold, the full one does.
+    if (!ArnoldAPI::create())
+    {
+        std::cout << "[ SKIPPED  ] Arnold is not found" << std::endl;
+        return;
+    }
+
+    const std::string file = ArchMakeTmpFileName("arnoldToUsdLayer", ".ass");
+    {
+        // The volume refers to the shader, the shaders are linked, and the
+        // strings and the names of the parameters look like the shaders.
+        std::ofstream ass(file);
+        ass << "standard_volume\n{\n name volShader\n density 1\n}\n"
+               "image\n{\n name tex\n filename \"volShader.tx\"\n}\n"
+               "standard_surface\n{\n name surf\n base_color tex\n"
+               " specular_color 1 1 1\n}\n"
+               "volume\n{\n name vol\n shader volShader\n"
+               " filename \"missing.vdb\"\n}\n";
+    }
+
+    // The metadata-only layer is first, so it's not read from the cache.
+    SdfLayerRefPtr metadata =
+        ArnoldUSDTranslator::arnoldToUsdLayer(file, /*metadataOnly*/ true);
+    SdfLayerRefPtr full = ArnoldUSDTranslator::arnoldToUsdLayer(file, false);
+
+    std::remove(file.c_str());
+
+    std::map<std::string, std::string> metadataHierarchy =
+        getHierarchy(metadata);
+
+    EXPECT_EQ(metadataHierarchy, getHierarchy(full));
+    EXPECT_TRUE(metadataHierarchy.count("/volShader"));
+    EXPECT_TRUE(metadataHierarchy.count("/surf"));
+    EXPECT_FALSE(metadataHierarchy.count("/tex"));
+}
@@ -0,0 +1,28 @@
+// Copyright 2017 Rodeo FX. All rights reserved.
+#include "walterUSDCommonUtils.h"
+
+#include <gtest/gtest.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST(getContentHash, testSameContent)
+{
+    std::string a = WalterUSDCommonUtils::getContentHash("#usda 1.0\n");
+    std::string b = WalterUSDCommonUtils::getContentHash("#usda 1.0\n");
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.size(), 16);
+}
+
+TEST(getContentHash, testDifferentContent)
+{
+    std::string a = WalterUSDCommonUtils::getContentHash("/cube");
+    std::string b = WalterUSDCommonUtils::getContentHash("/cube1");
+    EXPECT_NE(a, b);
+}
+
+TEST(getContentHash, testSeparator)
+{
+    std::string a = WalterUSDCommonUtils::getContentHash({"ab", "c"});
+    std::string b = WalterUSDCommonUtils::getContentHash({"a", "bc"});
+    EXPECT_NE(a, b);
+}
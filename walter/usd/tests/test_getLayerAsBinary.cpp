@@ -0,0 +1,52 @@
+// Copyright 2017 Rodeo FX. All rights reserved.
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/usd/attribute.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+
+#include "walterUSDCommonUtils.h"
+
+#include <gtest/gtest.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST(getLayerAsBinary, roundTrip)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    UsdPrim prim = stage->DefinePrim(SdfPath("/Foo"));
+    UsdAttribute attr =
+        prim.CreateAttribute(TfToken("values"), SdfValueTypeNames->FloatArray);
+    VtFloatArray values = {0.0f, 1.5f, 2.5f};
+    attr.Set(values, 1.0);
+
+    std::string binary =
+        WalterUSDCommonUtils::getLayerAsBinary(stage->GetRootLayer());
+    EXPECT_FALSE(binary.empty());
+    EXPECT_NE(binary.compare(0, 5, "#usda"), 0);
+
+    SdfLayerRefPtr layer = SdfLayer::CreateAnonymous("roundTrip.usda");
+    EXPECT_TRUE(WalterUSDCommonUtils::importLayerFromString(layer, binary));
+
+    UsdStageRefPtr result = UsdStage::Open(layer);
+    UsdPrim resultPrim = result->GetPrimAtPath(SdfPath("/Foo"));
+    EXPECT_TRUE(resultPrim);
+
+    VtFloatArray resultValues;
+    resultPrim.GetAttribute(TfToken("values")).Get(&resultValues, 1.0);
+    EXPECT_EQ(resultValues, values);
+}
+
+TEST(getLayerAsBinary, importText)
+{
+    SdfLayerRefPtr layer = SdfLayer::CreateAnonymous("importText.usda");
+    EXPECT_TRUE(WalterUSDCommonUtils::importLayerFromString(
+        layer, "#usda 1.0\n\ndef \"Foo\"\n{\n}\n\n"));
+    EXPECT_TRUE(layer->GetPrimAtPath(SdfPath("/Foo")));
+}
+
+TEST(getLayerAsBinary, corrupted)
+{
+    SdfLayerRefPtr layer = SdfLayer::CreateAnonymous("corrupted.usda");
+    EXPECT_FALSE(WalterUSDCommonUtils::importLayerFromString(
+        layer, "#usdc-base64\n!!!"));
+}
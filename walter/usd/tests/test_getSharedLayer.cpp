@@ -0,0 +1,41 @@
+// Copyright 2017 Rodeo FX. All rights reserved.
+#include <pxr/usd/sdf/layer.h>
+
+#include "walterUSDCommonUtils.h"
+
+#include <gtest/gtest.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST(getSharedLayer, sameContent)
+{
+    std::string content = "#usda 1.0\n\ndef \"Foo\"\n{\n}\n\n";
+
+    SdfLayerRefPtr a = WalterUSDCommonUtils::getSharedLayer(content);
+    SdfLayerRefPtr b = WalterUSDCommonUtils::getSharedLayer(content);
+
+    EXPECT_TRUE(a);
+    EXPECT_EQ(a, b);
+    EXPECT_TRUE(a->GetPrimAtPath(SdfPath("/Foo")));
+}
+
+TEST(getSharedLayer, differentContent)
+{
+    SdfLayerRefPtr a = WalterUSDCommonUtils::getSharedLayer(
+        "#usda 1.0\n\ndef \"Foo\"\n{\n}\n\n");
+    SdfLayerRefPtr b = WalterUSDCommonUtils::getSharedLayer(
+        "#usda 1.0\n\ndef \"Bar\"\n{\n}\n\n");
+
+    EXPECT_NE(a, b);
+}
+
+TEST(getSharedLayer, clear)
+{
+    std::string content = "#usda 1.0\n\ndef \"Foo\"\n{\n}\n\n";
+
+    SdfLayerRefPtr a = WalterUSDCommonUtils::getSharedLayer(content);
+    WalterUSDCommonUtils::clearSharedLayers();
+    SdfLayerRefPtr b = WalterUSDCommonUtils::getSharedLayer(content);
+
+    EXPECT_NE(a, b);
+}
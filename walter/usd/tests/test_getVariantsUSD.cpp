@@ -0,0 +1,83 @@
+// Copyright 2017 Rodeo FX. All rights reserved.
+#include <pxr/usd/usd/editContext.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usd/variantSets.h>
+
+#include "walterUSDCommonUtils.h"
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST(getVariantsUSD, testNewVariantSetAfterQuery)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    UsdPrim foo = stage->DefinePrim(SdfPath("/Foo"));
+    UsdVariantSet colors = foo.GetVariantSets().AddVariantSet("colors");
+    colors.AddVariant("red");
+    colors.SetVariantSelection("red");
+
+    std::vector<std::string> result =
+        WalterUSDCommonUtils::getVariantsUSD(stage, "", true);
+    EXPECT_EQ(result.size(), 1);
+
+    // The index of the variants should see the new prims.
+    UsdPrim bar = stage->DefinePrim(SdfPath("/Bar/Baz"));
+    UsdVariantSet sizes = bar.GetVariantSets().AddVariantSet("sizes");
+    sizes.AddVariant("big");
+    sizes.SetVariantSelection("big");
+
+    result = WalterUSDCommonUtils::getVariantsUSD(stage, "", true);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(
+        result[1],
+        "{ \"prim\": \"/Bar/Baz\", \"variants\": [{ \"set\": \"sizes\", "
+        "\"names\": [\"big\"], \"selection\": \"big\" } ]  }");
+
+    result = WalterUSDCommonUtils::getVariantsUSD(stage, "/Bar", true);
+    EXPECT_EQ(result.size(), 1);
+
+    result = WalterUSDCommonUtils::getVariantsUSD(stage, "/Bar", false);
+    EXPECT_EQ(result.size(), 0);
+}
+
+TEST(getVariantsUSD, testVariantInsideVariant)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    UsdPrim foo = stage->DefinePrim(SdfPath("/Foo"));
+    UsdVariantSet lod = foo.GetVariantSets().AddVariantSet("lod");
+    lod.AddVariant("low");
+    lod.AddVariant("high");
+
+    // Only the high variant has a child with variants.
+    lod.SetVariantSelection("high");
+    {
+        UsdEditContext context(lod.GetVariantEditContext());
+        UsdPrim child = stage->DefinePrim(SdfPath("/Foo/Child"));
+        UsdVariantSet colors = child.GetVariantSets().AddVariantSet("colors");
+        colors.AddVariant("red");
+        colors.AddVariant("green");
+    }
+    lod.SetVariantSelection("low");
+
+    std::vector<std::string> result =
+        WalterUSDCommonUtils::getVariantsUSD(stage, "", true);
+    EXPECT_EQ(result.size(), 1);
+
+    // Switching the parent should make the child visible, and the same call
+    // should set the variant of the child.
+    WalterUSDCommonUtils::setVariantUSD(stage, "/Foo{lod=high}");
+    WalterUSDCommonUtils::setVariantUSD(stage, "/Foo{colors=green}");
+
+    result = WalterUSDCommonUtils::getVariantsUSD(stage, "", true);
+    ASSERT_EQ(result.size(), 2);
+
+    UsdPrim child = stage->GetPrimAtPath(SdfPath("/Foo/Child"));
+    ASSERT_TRUE(child);
+    EXPECT_EQ(
+        child.GetVariantSets().GetVariantSet("colors").GetVariantSelection(),
+        "green");
+}
@@ -0,0 +1,56 @@
+// Copyright 2017 Rodeo FX. All rights reserved.
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+
+#include "walterUSDCommonUtils.h"
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TEST(primsMatchingExpression, testPrefixAndRegex)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    stage->DefinePrim(SdfPath("/Root/cube"));
+    stage->DefinePrim(SdfPath("/Root/cube_1"));
+    stage->DefinePrim(SdfPath("/Root/sphere"));
+    stage->DefinePrim(SdfPath("/Root/cube/shape"));
+
+    std::vector<std::string> result =
+        WalterUSDCommonUtils::primPathsMatchingExpression(stage, "/Root/cube");
+    ASSERT_EQ(result.size(), 3);
+    // The order of the traversal.
+    EXPECT_EQ(result[0], "/Root/cube");
+    EXPECT_EQ(result[1], "/Root/cube/shape");
+    EXPECT_EQ(result[2], "/Root/cube_1");
+
+    result = WalterUSDCommonUtils::primPathsMatchingExpression(
+        stage, "/Root/.*e/shape");
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], "/Root/cube/shape");
+
+    result = WalterUSDCommonUtils::primPathsMatchingExpression(
+        stage, "/Root/(cube|sphere)");
+    EXPECT_EQ(result.size(), 2);
+
+    result = WalterUSDCommonUtils::primPathsMatchingExpression(
+        stage, "/Root/cubes?_1");
+    EXPECT_EQ(result.size(), 1);
+
+    EXPECT_TRUE(WalterUSDCommonUtils::expressionIsMatching(stage, ".*sphere"));
+    EXPECT_FALSE(WalterUSDCommonUtils::expressionIsMatching(stage, ".*cone"));
+}
+
+TEST(primsMatchingExpression, testNewPrim)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    stage->DefinePrim(SdfPath("/Root/cube"));
+
+    EXPECT_FALSE(WalterUSDCommonUtils::expressionIsMatching(stage, ".*cone"));
+
+    // The index should see the new prim.
+    stage->DefinePrim(SdfPath("/Root/cone"));
+    EXPECT_TRUE(WalterUSDCommonUtils::expressionIsMatching(stage, ".*cone"));
+}
@@ -4,6 +4,7 @@
 #include <pxr/usd/usd/stage.h>
 
 #include "walterUSDCommonUtils.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -63,9 +64,43 @@ TEST(propertiesUSD, test_usdProperties)
     EXPECT_EQ(properties[3], "{ \"name\": \"creaseLengths\", \"type\": \"VtArray<int>\", \"arraySize\": 0, \"value\": [] }");
     EXPECT_EQ(properties[4], "{ \"name\": \"creaseSharpnesses\", \"type\": \"VtArray<float>\", \"arraySize\": 0, \"value\": [] }");
     EXPECT_EQ(properties[5], "{ \"name\": \"doubleSided\", \"type\": \"bool\", \"arraySize\": -1, \"value\": 0 }");
-    EXPECT_EQ(properties[6], "{ \"name\": \"extent\", \"type\": \"VtArray<GfVec3f>\", \"arraySize\": 2, \"value\": [[-0.500000, 0.000000, 0.000000]] }");
+    EXPECT_EQ(properties[6], "{ \"name\": \"extent\", \"type\": \"VtArray<GfVec3f>\", \"arraySize\": 2, \"value\": [[-0.500000, 0.000000, 0.000000], [0.500000, 0.785398, 0.000000]] }");
     EXPECT_EQ(properties[7], "{ \"name\": \"faceVaryingLinearInterpolation\", \"type\": \"TfToken\", \"arraySize\": -1, \"value\": \"\" }");
     EXPECT_EQ(properties[8], "{ \"name\": \"faceVertexCounts\", \"type\": \"VtArray<int>\", \"arraySize\": 1, \"value\": [3] }");
-    EXPECT_EQ(properties[9], "{ \"name\": \"faceVertexIndices\", \"type\": \"VtArray<int>\", \"arraySize\": 3, \"value\": [0] }");
+    EXPECT_EQ(properties[9], "{ \"name\": \"faceVertexIndices\", \"type\": \"VtArray<int>\", \"arraySize\": 3, \"value\": [0, 1, 2] }");
     EXPECT_EQ(properties[10], "{ \"name\": \"holeIndices\", \"type\": \"VtArray<int>\", \"arraySize\": 0, \"value\": [] }");
 }
+
+TEST(propertiesUSD, test_usdPropertiesPreview)
+{
+    std::string stageAsStr = R"(#usda 1.0
+
+    def Mesh "mesh0"
+    {
+        int[] faceVertexIndices = [0, 1, 2, 3]
+        rel material:binding = </material>
+    }
+    )";
+
+    UsdStageRefPtr stage = UsdStage::CreateInMemory();
+
+    SdfLayerHandle handle = stage->GetSessionLayer();
+    handle->ImportFromString(stageAsStr);
+
+    // Only two elements of the arrays and the relationships.
+    std::vector<std::string> properties =
+        WalterUSDCommonUtils::propertiesUSD(stage, "/mesh0", 0, false, 2);
+
+    auto indices = std::find(
+        properties.begin(),
+        properties.end(),
+        "{ \"name\": \"faceVertexIndices\", \"type\": \"VtArray<int>\", "
+        "\"arraySize\": 4, \"value\": [0, 1] }");
+    EXPECT_NE(indices, properties.end());
+
+    auto binding = std::find_if(
+        properties.begin(), properties.end(), [](const std::string& p) {
+            return p.find("\"name\": \"binding\"") != std::string::npos;
+        });
+    EXPECT_NE(binding, properties.end());
+}
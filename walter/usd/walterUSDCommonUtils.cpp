@@ -2,7 +2,17 @@
 
 #include "PathUtil.h"
 #include "walterUSDCommonUtils.h"
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/pathUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/tf/weakBase.h>
 #include <pxr/usd/ar/resolver.h>
+#include <pxr/usd/sdf/schema.h>
+#include <pxr/usd/usd/notice.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usd/variantSets.h>
@@ -11,9 +21,31 @@
 #include "schemas/expression.h"
 #include "walterUsdConversion.h"
 #include <boost/algorithm/string.hpp>
+#include <boost/noncopyable.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
+TF_DEFINE_ENV_SETTING(
+    WALTER_PREWARM_ALEMBICS,
+    false,
+    "Read the headers of the alembic archives in parallel before composing "
+    "the stage.");
+
 /**
  * @brief Converts the primPath (Path of the primitive in the stage) to the
  * corresponding SdfPath.
@@ -29,6 +61,244 @@ SdfPath GetSdfPathFromPrimPath(const char* primPath)
         SdfPath(primPath);
 }
 
+namespace
+{
+// The prefix of the layer encoded with getLayerAsBinary. usda always starts
+// with "#usda", so they can't be confused.
+const std::string sBinaryLayerPrefix = "#usdc-base64\n";
+
+const char sBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * @brief Encodes the data to base64.
+ *
+ * @param data The binary data.
+ *
+ * @return The base64 string.
+ */
+std::string encodeBase64(const std::string& data)
+{
+    std::string result;
+    result.reserve((data.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3)
+    {
+        uint32_t n = (uint8_t)data[i] << 16 | (uint8_t)data[i + 1] << 8 |
+                     (uint8_t)data[i + 2];
+        result.push_back(sBase64Chars[(n >> 18) & 63]);
+        result.push_back(sBase64Chars[(n >> 12) & 63]);
+        result.push_back(sBase64Chars[(n >> 6) & 63]);
+        result.push_back(sBase64Chars[n & 63]);
+    }
+
+    // The tail.
+    size_t rest = data.size() - i;
+    if (rest)
+    {
+        uint32_t n = (uint8_t)data[i] << 16;
+        if (rest == 2)
+        {
+            n |= (uint8_t)data[i + 1] << 8;
+        }
+
+        result.push_back(sBase64Chars[(n >> 18) & 63]);
+        result.push_back(sBase64Chars[(n >> 12) & 63]);
+        result.push_back(rest == 2 ? sBase64Chars[(n >> 6) & 63] : '=');
+        result.push_back('=');
+    }
+
+    return result;
+}
+
+/**
+ * @brief Decodes base64 starting from the given position.
+ *
+ * @param str The base64 string.
+ * @param start The position of the first character to decode.
+ * @param oData The binary data.
+ *
+ * @return False if the string contains the characters that are not base64.
+ */
+bool decodeBase64(const std::string& str, size_t start, std::string& oData)
+{
+    // The lookup table. -1 is an invalid character.
+    static const std::vector<int> sTable = []() {
+        std::vector<int> table(256, -1);
+        for (int i = 0; i < 64; i++)
+        {
+            table[(uint8_t)sBase64Chars[i]] = i;
+        }
+        return table;
+    }();
+
+    oData.clear();
+    oData.reserve((str.size() - start) / 4 * 3);
+
+    uint32_t n = 0;
+    int bits = 0;
+    for (size_t i = start; i < str.size(); i++)
+    {
+        char c = str[i];
+        if (c == '=')
+        {
+            break;
+        }
+
+        if (c == '\n' || c == '\r')
+        {
+            continue;
+        }
+
+        int value = sTable[(uint8_t)c];
+        if (value < 0)
+        {
+            return false;
+        }
+
+        n = n << 6 | value;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            oData.push_back((char)((n >> bits) & 0xff));
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns a unique name of a temporary crate file. USD can only read and
+ * write crate with files, so the binary layers are passed through a file. The
+ * shared memory is used when it's available, so the disk is not touched.
+ *
+ * @return The full file name.
+ */
+std::string makeTmpLayerFileName()
+{
+    static const bool hasSharedMemory = TfIsDir("/dev/shm", true);
+    if (!hasSharedMemory)
+    {
+        return ArchMakeTmpFileName("walterLayer", ".usdc");
+    }
+
+    // The counter makes it unique for all the threads of the process.
+    static std::atomic<unsigned> counter(0);
+    return TfStringPrintf(
+        "/dev/shm/walterLayer.%d.%u.usdc", (int)getpid(), counter++);
+}
+}
+
+/**
+ * @brief Reads the Ogawa group and the data of its children. The groups of the
+ * children are read recursively up to the given depth. In Ogawa, the group is
+ * the number of the children followed by their positions. The position with
+ * the highest bit set is the data, which is its size followed by the bytes.
+ *
+ * @param file The archive.
+ * @param pos The position of the group.
+ * @param depth The number of the levels of the child groups to read.
+ */
+static void prewarmOgawaGroup(std::ifstream& file, uint64_t pos, int depth)
+{
+    static const uint64_t dataBit = 0x8000000000000000ULL;
+    // The archive is probably corrupted if it's bigger.
+    static const uint64_t maxChildren = 1 << 20;
+    // The headers and the metadata are small. We don't read the samples.
+    static const uint64_t maxDataSize = 1 << 20;
+
+    uint64_t numChildren = 0;
+    file.seekg(pos);
+    if (!file.read((char*)&numChildren, sizeof(numChildren)) ||
+        numChildren > maxChildren)
+    {
+        return;
+    }
+
+    std::vector<uint64_t> children(numChildren);
+    if (!file.read((char*)children.data(), numChildren * sizeof(uint64_t)))
+    {
+        return;
+    }
+
+    std::vector<char> buffer;
+    for (uint64_t child : children)
+    {
+        if (child & dataBit)
+        {
+            uint64_t dataPos = child & ~dataBit;
+            if (!dataPos)
+            {
+                // Empty data.
+                continue;
+            }
+
+            uint64_t size = 0;
+            file.seekg(dataPos);
+            if (!file.read((char*)&size, sizeof(size)))
+            {
+                return;
+            }
+
+            buffer.resize(std::min(size, maxDataSize));
+            if (!file.read(buffer.data(), buffer.size()))
+            {
+                return;
+            }
+        }
+        else if (child && depth > 0)
+        {
+            prewarmOgawaGroup(file, child, depth - 1);
+        }
+    }
+}
+
+/**
+ * @brief Reads the blocks of the Ogawa archives that Alembic reads when the
+ * archive is opened: the header, the root group with the version, the time
+ * samplings and the metadata, and the group of the top object with the headers
+ * of its children. The archives are read at the same time, so when the stage
+ * is composed, the data is already in the cache of the file system. It's
+ * useful when there are a lot of archives on the network storage.
+ *
+ * @param archives The alembic archives. The relative paths are skipped because
+ * they need the resolver context.
+ */
+static void prewarmAlembics(const std::vector<std::string>& archives)
+{
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, archives.size()),
+        [&archives](const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i != r.end(); i++)
+            {
+                const std::string& archive = archives[i];
+                if (TfIsRelativePath(archive))
+                {
+                    continue;
+                }
+
+                std::ifstream file(archive, std::ios::binary);
+
+                // "Ogawa", the frozen flag, the version and the position of
+                // the root group.
+                char header[16];
+                if (!file.read(header, sizeof(header)) ||
+                    std::string(header, 5) != "Ogawa")
+                {
+                    continue;
+                }
+
+                uint64_t rootPos;
+                memcpy(&rootPos, header + 8, sizeof(rootPos));
+
+                // The root group and the top object.
+                prewarmOgawaGroup(file, rootPos, 1);
+            }
+        });
+}
+
 SdfLayerRefPtr WalterUSDCommonUtils::getUSDLayer(const std::string& path)
 {
     std::vector<std::string> archives;
@@ -39,9 +309,6 @@ SdfLayerRefPtr WalterUSDCommonUtils::getUSDLayer(const std::string& path)
 SdfLayerRefPtr WalterUSDCommonUtils::getUSDLayer(
     const std::vector<std::string>& paths)
 {
-    ArResolver& resolver = ArGetResolver();
-    resolver.Clear();
-
     // Open and compose several layers. Since we can compose several different
     // formats, we need to be sure that alembics are composed with AbcCoreLayer.
     // To do it, it's necessary to provide the list of alembics as a single
@@ -49,6 +316,7 @@ SdfLayerRefPtr WalterUSDCommonUtils::getUSDLayer(
     // all the layers to contain one usd or list of abc files.
     std::vector<std::string> allArchives;
     std::vector<std::string> alembicArchives;
+    std::vector<std::string> allAlembics;
     for (const std::string archive : paths)
     {
         if (archive.empty())
@@ -61,6 +329,7 @@ SdfLayerRefPtr WalterUSDCommonUtils::getUSDLayer(
             // We need to compose the alembic files with AbcCoreLayer and we
             // need to keep all the alembics in the one single string.
             alembicArchives.push_back(archive);
+            allAlembics.push_back(archive);
         }
         else
         {
@@ -81,6 +350,11 @@ SdfLayerRefPtr WalterUSDCommonUtils::getUSDLayer(
         allArchives.push_back(boost::algorithm::join(alembicArchives, ":"));
     }
 
+    if (TfGetEnvSetting(WALTER_PREWARM_ALEMBICS) && allAlembics.size() > 1)
+    {
+        prewarmAlembics(allAlembics);
+    }
+
     // We can check if we don't have archives or we have only one and skip the
     // anonymous layer generation like this:
     // if (allArchives.empty())
@@ -104,6 +378,11 @@ SdfLayerRefPtr WalterUSDCommonUtils::getUSDLayer(
     return layer;
 }
 
+void WalterUSDCommonUtils::clearResolverCache()
+{
+    ArGetResolver().Clear();
+}
+
 SdfLayerRefPtr WalterUSDCommonUtils::getAnonymousLayer(
     UsdStageRefPtr stage,
     const std::string& name)
@@ -153,6 +432,199 @@ SdfLayerRefPtr WalterUSDCommonUtils::getAnonymousLayer(
     return anonymousLayer;
 }
 
+std::string WalterUSDCommonUtils::getContentHash(
+    const std::vector<std::string>& strings)
+{
+    // 64-bit FNV-1a. We don't use std::hash because it's not guaranteed to be
+    // the same with different compilers, and the result is used in the names
+    // of Arnold nodes that should be the same on all the farm machines.
+    uint64_t hash = 14695981039346656037ULL;
+    for (const std::string& str : strings)
+    {
+        for (const unsigned char c : str)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+
+        // Separator. We need it because {"ab", "c"} and {"a", "bc"} should
+        // produce different hashes.
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    }
+
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)hash);
+    return buffer;
+}
+
+std::string WalterUSDCommonUtils::getContentHash(const std::string& str)
+{
+    return getContentHash(std::vector<std::string>{str});
+}
+
+std::string WalterUSDCommonUtils::getLayerAsBinary(const SdfLayerHandle& layer)
+{
+    if (!layer)
+    {
+        return {};
+    }
+
+    // USD can only write crate to a file, so we use a temporary one.
+    std::string fileName = makeTmpLayerFileName();
+    if (!layer->Export(fileName))
+    {
+        std::remove(fileName.c_str());
+
+        // Don't lose the layer, the text form is still valid.
+        std::string text;
+        if (!layer->ExportToString(&text))
+        {
+            TF_WARN("Can't save the layer %s", layer->GetIdentifier().c_str());
+            return {};
+        }
+
+        return text;
+    }
+
+    std::string data;
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        data.assign(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+    }
+
+    std::remove(fileName.c_str());
+
+    return sBinaryLayerPrefix + encodeBase64(data);
+}
+
+bool WalterUSDCommonUtils::importLayerFromString(
+    const SdfLayerHandle& layer,
+    const std::string& str)
+{
+    if (!layer)
+    {
+        return false;
+    }
+
+    if (str.compare(0, sBinaryLayerPrefix.size(), sBinaryLayerPrefix) != 0)
+    {
+        // It's a usda text.
+        return layer->ImportFromString(str);
+    }
+
+    std::string data;
+    if (!decodeBase64(str, sBinaryLayerPrefix.size(), data))
+    {
+        TF_WARN("Can't decode the binary layer");
+        return false;
+    }
+
+    // USD can only read crate from a file, so we use a temporary one.
+    std::string fileName = makeTmpLayerFileName();
+    {
+        std::ofstream file(fileName, std::ios::binary);
+        file.write(data.data(), data.size());
+    }
+
+    bool result = false;
+    {
+        SdfLayerRefPtr binaryLayer = SdfLayer::FindOrOpen(fileName);
+        if (binaryLayer)
+        {
+            // Copy everything to the given layer. The temporary layer is
+            // released at the end of the scope.
+            layer->TransferContent(binaryLayer);
+            result = true;
+        }
+    }
+
+    std::remove(fileName.c_str());
+
+    return result;
+}
+
+/** @brief The layers cached by getSharedLayer. The key is the hash of the
+ * content. The content is kept to detect the collisions of the hash. */
+class SharedLayerRegistry : boost::noncopyable
+{
+public:
+    typedef SharedLayerRegistry This;
+
+    static SharedLayerRegistry& getInstance()
+    {
+        return TfSingleton<This>::GetInstance();
+    }
+
+    SdfLayerRefPtr getLayer(const std::string& content)
+    {
+        const std::string hash = WalterUSDCommonUtils::getContentHash(content);
+
+        {
+            ScopedLock lock(mMutex);
+            auto it = mLayers.find(hash);
+            if (it != mLayers.end() && it->second.first == content)
+            {
+                return it->second.second;
+            }
+        }
+
+        // Parse it without locking, so several stages can parse different
+        // layers at the same time.
+        SdfLayerRefPtr layer = SdfLayer::CreateAnonymous(hash + ".usda");
+        if (!WalterUSDCommonUtils::importLayerFromString(layer, content))
+        {
+            return SdfLayerRefPtr();
+        }
+
+        ScopedLock lock(mMutex);
+        auto result = mLayers.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(hash),
+            std::forward_as_tuple(content, layer));
+
+        if (result.first->second.first != content)
+        {
+            // Another content has the same hash. It's very unlikely, we don't
+            // cache this one.
+            return layer;
+        }
+
+        // If another thread parsed the same content meanwhile, we use its
+        // layer, so all the stages still share one.
+        return result.first->second.second;
+    }
+
+    void clear()
+    {
+        ScopedLock lock(mMutex);
+        mLayers.clear();
+    }
+
+private:
+    typedef std::mutex Mutex;
+    typedef std::lock_guard<Mutex> ScopedLock;
+
+    std::unordered_map<std::string, std::pair<std::string, SdfLayerRefPtr>>
+        mLayers;
+
+    Mutex mMutex;
+};
+
+TF_INSTANTIATE_SINGLETON(SharedLayerRegistry);
+
+SdfLayerRefPtr WalterUSDCommonUtils::getSharedLayer(const std::string& content)
+{
+    return SharedLayerRegistry::getInstance().getLayer(content);
+}
+
+void WalterUSDCommonUtils::clearSharedLayers()
+{
+    SharedLayerRegistry::getInstance().clear();
+}
+
 bool WalterUSDCommonUtils::setUSDVariantsLayer(
     UsdStageRefPtr stage,
     const char* variants)
@@ -164,7 +636,7 @@ bool WalterUSDCommonUtils::setUSDVariantsLayer(
         variantLayer->Clear();
     }
 
-    else if (!variantLayer->ImportFromString(variants))
+    else if (!importLayerFromString(variantLayer, variants))
     {
         variantLayer->Clear();
         return false;
@@ -184,7 +656,7 @@ bool WalterUSDCommonUtils::setUSDPurposeLayer(
         purposeLayer->Clear();
     }
 
-    else if (!purposeLayer->ImportFromString(purpose))
+    else if (!importLayerFromString(purposeLayer, purpose))
     {
         purposeLayer->Clear();
         return false;
@@ -220,7 +692,7 @@ bool WalterUSDCommonUtils::setUSDVisibilityLayer(
         visibilityLayer->Clear();
     }
 
-    else if (!visibilityLayer->ImportFromString(visibility))
+    else if (!importLayerFromString(visibilityLayer, visibility))
     {
         visibilityLayer->Clear();
         return false;
@@ -253,7 +725,8 @@ std::vector<std::string> WalterUSDCommonUtils::propertiesUSD(
     UsdStageRefPtr stage,
     const char* primPath,
     double time,
-    bool attributeOnly)
+    bool attributeOnly,
+    int maxElementCount)
 {
     std::vector<std::string> result;
     SdfPath path = GetSdfPathFromPrimPath(primPath);
@@ -267,26 +740,50 @@ std::vector<std::string> WalterUSDCommonUtils::propertiesUSD(
     UsdTimeCode tc(time);
     const std::vector<UsdProperty>& properties = prim.GetProperties();
 
-    for (unsigned i = 0; i < properties.size(); i++)
-    {
-        UsdProperty const& prop = properties[i];
+    // The properties are converted in parallel because reading the values from
+    // the layers and converting them to strings is the slow part. Each property
+    // has its own slot, so the order is the same as in USD.
+    std::vector<std::string> descriptions(properties.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, properties.size()),
+        [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                UsdProperty const& prop = properties[i];
+
+                int arraySize = -1;
+                std::string type, value;
+                if (WalterUsdConversion::getPropertyValueAsString(
+                        prop,
+                        tc,
+                        type,
+                        value,
+                        arraySize,
+                        maxElementCount,
+                        attributeOnly))
+                {
+                    descriptions[i] =
+                        WalterUsdConversion::constuctStringRepresentation(
+                            prop.GetBaseName().GetText(),
+                            prop.Is<UsdAttribute>() ? "Attribute"
+                                                    : "Relationship",
+                            type,
+                            value,
+                            arraySize);
+                }
+            }
+        });
 
-        int arraySize = -1;
-        std::string type, value;
-        if (WalterUsdConversion::getPropertyValueAsString(
-                prop, tc, type, value, arraySize, attributeOnly))
+    // The description is never empty if the property was converted.
+    result.reserve(descriptions.size());
+    for (std::string& description : descriptions)
+    {
+        if (!description.empty())
         {
-            std::string description =
-                WalterUsdConversion::constuctStringRepresentation(
-                    prop.GetBaseName().GetText(),
-                    prop.Is<UsdAttribute>() ? "Attribute" : "Relationship",
-                    type,
-                    value,
-                    arraySize);
-
-            result.push_back(description);
+            result.push_back(std::move(description));
         }
     }
+
     return result;
 }
 
@@ -299,69 +796,230 @@ std::string WalterUSDCommonUtils::getVisibilityLayerAsText(UsdStageRefPtr stage)
 }
 
 /**
- * @brief Traverses recursively the USD hierarchy to get the variants.
+ * @brief Returns the index of the type T of the stage. The index is created at
+ * the first call and it's kept until the stage is destroyed. The indices of the
+ * destroyed stages are released here.
  *
- * @param prim The USD primitive the get the variants from.
- * @param result The variants list (as an array of json).
+ * @param stage The USD stage.
  *
+ * @return The index.
  */
-void GetPrimVariants(
-    UsdPrim const& prim,
-    bool recursively,
-    std::vector<std::string>& result)
+template <typename T>
+std::shared_ptr<T> getStageIndex(const UsdStageRefPtr& stage)
 {
-    const UsdVariantSets& variantsSets = prim.GetVariantSets();
-    std::vector<std::string> variantsSetsName = variantsSets.GetNames();
+    static std::unordered_map<const UsdStage*, std::shared_ptr<T>> sIndices;
+    static std::mutex sMutex;
 
-    std::string jsonStr = "{ ";
-    if (variantsSetsName.size() > 0)
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    // The stage can be destroyed and a new one can be created at the same
+    // address, so the index is valid only if the stage is still alive.
+    auto it = sIndices.find(get_pointer(stage));
+    if (it != sIndices.end() && !it->second->isExpired())
     {
-        jsonStr += "\"prim\": \"" + prim.GetPath().GetString() + "\"";
-        jsonStr += ", \"variants\": [";
+        return it->second;
     }
 
-    for (unsigned i = 0; i < variantsSetsName.size(); ++i)
+    // Release the indices of the destroyed stages.
+    for (it = sIndices.begin(); it != sIndices.end();)
     {
-        const UsdVariantSet& variantsSet =
-            variantsSets.GetVariantSet(variantsSetsName[i]);
+        if (it->second->isExpired())
+        {
+            it = sIndices.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
 
-        jsonStr += "{ ";
-        jsonStr += "\"set\": \"" + variantsSetsName[i] + "\", \"names\": [";
+    std::shared_ptr<T> index = std::make_shared<T>(stage);
+    sIndices[get_pointer(stage)] = index;
 
-        std::vector<std::string> variantsName = variantsSet.GetVariantNames();
-        for (unsigned j = 0; j < variantsName.size(); ++j)
+    return index;
+}
+
+/**
+ * @brief The list of the prims that have variant sets. It's built once per
+ * stage, and it's updated when USD notifies that the stage is recomposed, so
+ * the variant queries don't need to traverse the whole stage. The prims are
+ * stored in the traversal order.
+ */
+class VariantIndex : public TfWeakBase
+{
+public:
+    VariantIndex(const UsdStageRefPtr& stage) :
+            mStage(stage),
+            mDirty(true)
+    {
+        mKey = TfNotice::Register(
+            TfCreateWeakPtr(this),
+            &VariantIndex::onObjectsChanged,
+            UsdStageWeakPtr(stage));
+    }
+
+    ~VariantIndex() { TfNotice::Revoke(mKey); }
+
+    /**
+     * @brief Returns the prims that have variant sets.
+     *
+     * @param root Only the prims under this path are returned.
+     */
+    SdfPathVector getPrims(const SdfPath& root)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        update();
+
+        // The children are always right after the parent, so we need to find
+        // the first one and copy while they have the prefix.
+        SdfPathVector prims;
+        auto it = std::find_if(
+            mPrims.begin(), mPrims.end(), [&root](const SdfPath& path) {
+                return path.HasPrefix(root);
+            });
+        for (; it != mPrims.end() && it->HasPrefix(root); ++it)
+        {
+            prims.push_back(*it);
+        }
+
+        return prims;
+    }
+
+    /**
+     * @brief Checks if the stage of the index is destroyed.
+     */
+    bool isExpired() const { return !mStage; }
+
+private:
+    void onObjectsChanged(const UsdNotice::ObjectsChanged& notice)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const SdfPath& path : notice.GetResyncedPaths())
+        {
+            mResynced.push_back(path.GetPrimPath());
+        }
+    }
+
+    // Appends the prims with variant sets of the subtree. The variant sets are
+    // detected with the metadata to avoid composing the variant set names of
+    // all the prims.
+    void traverse(const SdfPath& root, SdfPathVector& prims) const
+    {
+        UsdPrim prim = mStage->GetPrimAtPath(root);
+        if (!prim)
         {
-            jsonStr += "\"" + variantsName[j] + "\"";
-            if(j < (variantsName.size() - 1))
+            return;
+        }
+
+        for (const UsdPrim& current : UsdPrimRange(prim))
+        {
+            if (current.HasMetadata(SdfFieldKeys->VariantSetNames))
             {
-                jsonStr += ", ";
+                prims.push_back(current.GetPath());
             }
         }
-        jsonStr += "], \"selection\": \"" + variantsSet.GetVariantSelection() + "\"";
-        jsonStr += " } ";
-        if (i < variantsSetsName.size() - 1)
+    }
+
+    // Applies the recompositions. Only the resynced subtrees are traversed
+    // again. If the prims with variants appeared in a new place, the index is
+    // rebuilt because we don't know where to insert them.
+    void update()
+    {
+        for (const SdfPath& resynced : mResynced)
         {
-            jsonStr += ", ";
+            if (mDirty)
+            {
+                break;
+            }
+
+            auto first = std::find_if(
+                mPrims.begin(), mPrims.end(), [&resynced](const SdfPath& path) {
+                    return path.HasPrefix(resynced);
+                });
+            auto last = std::find_if(first, mPrims.end(), [&resynced](
+                const SdfPath& path) { return !path.HasPrefix(resynced); });
+
+            SdfPathVector prims;
+            traverse(resynced, prims);
+
+            if (first == last && !prims.empty())
+            {
+                mDirty = true;
+                break;
+            }
+
+            first = mPrims.erase(first, last);
+            mPrims.insert(first, prims.begin(), prims.end());
         }
-        else
+
+        mResynced.clear();
+
+        if (mDirty)
         {
-            jsonStr += "] ";
+            mPrims.clear();
+            traverse(SdfPath::AbsoluteRootPath(), mPrims);
+            mDirty = false;
         }
     }
-    jsonStr += " }";
 
-    if (variantsSetsName.size() > 0)
+    UsdStageWeakPtr mStage;
+    TfNotice::Key mKey;
+    std::mutex mMutex;
+    bool mDirty;
+    SdfPathVector mPrims;
+    SdfPathVector mResynced;
+};
+
+/**
+ * @brief Appends the variants of the primitive to the json.
+ *
+ * @param prim The USD primitive the get the variants from.
+ * @param json The string to append.
+ *
+ * @return False if the prim doesn't have variants.
+ */
+bool appendPrimVariants(UsdPrim const& prim, std::string& json)
+{
+    const UsdVariantSets& variantsSets = prim.GetVariantSets();
+    std::vector<std::string> variantsSetsName = variantsSets.GetNames();
+    if (variantsSetsName.empty())
     {
-        result.push_back(jsonStr);
+        return false;
     }
 
-    if(recursively)
+    json.append("{ \"prim\": \"")
+        .append(prim.GetPath().GetString())
+        .append("\", \"variants\": [");
+
+    for (unsigned i = 0; i < variantsSetsName.size(); ++i)
     {
-        for (const UsdPrim& child : prim.GetChildren())
+        const UsdVariantSet& variantsSet =
+            variantsSets.GetVariantSet(variantsSetsName[i]);
+
+        json.append("{ \"set\": \"")
+            .append(variantsSetsName[i])
+            .append("\", \"names\": [");
+
+        std::vector<std::string> variantsName = variantsSet.GetVariantNames();
+        for (unsigned j = 0; j < variantsName.size(); ++j)
         {
-            GetPrimVariants(child, recursively, result);
+            json.append("\"").append(variantsName[j]).append("\"");
+            if (j < (variantsName.size() - 1))
+            {
+                json.append(", ");
+            }
         }
+
+        json.append("], \"selection\": \"")
+            .append(variantsSet.GetVariantSelection())
+            .append("\" } ");
+
+        json.append(i < variantsSetsName.size() - 1 ? ", " : "] ");
     }
+
+    json.append(" }");
+
+    return true;
 }
 
 std::vector<std::string> WalterUSDCommonUtils::getVariantsUSD(
@@ -377,36 +1035,32 @@ std::vector<std::string> WalterUSDCommonUtils::getVariantsUSD(
         return {};
     }
 
-    GetPrimVariants(
-        prim,
-        recursively,
-        result);
-
-    return result;
-}
+    std::string json;
 
-/**
- * @brief Traverses recursively the USD hierarchy to set the selected variant.
- *
- * @param prim The USD primitive.
- * @param variantName const char* The variant to set.
- * @param variantSetName const char* The variantSet.
- */
-void SetVariantsRecursively(
-    UsdPrim const& prim,
-    const char* variantName,
-    const char* variantSetName)
-{
-    UsdVariantSets variantsSets = prim.GetVariantSets();
-    if (variantsSets.HasVariantSet(variantSetName))
+    if (!recursively)
     {
-        variantsSets.SetSelection(variantSetName, variantName);
+        if (appendPrimVariants(prim, json))
+        {
+            result.push_back(json);
+        }
+
+        return result;
     }
 
-    for (const UsdPrim& child : prim.GetChildren())
+    // Only the prims with variants are visited.
+    std::shared_ptr<VariantIndex> index = getStageIndex<VariantIndex>(stage);
+    for (const SdfPath& variantPath : index->getPrims(path))
     {
-        SetVariantsRecursively(child, variantName, variantSetName);
+        UsdPrim variantPrim = stage->GetPrimAtPath(variantPath);
+
+        json.clear();
+        if (variantPrim && appendPrimVariants(variantPrim, json))
+        {
+            result.push_back(json);
+        }
     }
+
+    return result;
 }
 
 void WalterUSDCommonUtils::setVariantUSD(
@@ -423,7 +1077,39 @@ void WalterUSDCommonUtils::setVariantUSD(
         return;
     }
 
-    SetVariantsRecursively(prim, variantName, variantSetName);
+    std::shared_ptr<VariantIndex> index = getStageIndex<VariantIndex>(stage);
+
+    // Only the prims with variants are visited.
+    SdfPathVector prims = index->getPrims(path);
+    for (size_t i = 0; i < prims.size(); i++)
+    {
+        UsdPrim variantPrim = stage->GetPrimAtPath(prims[i]);
+        if (!variantPrim)
+        {
+            continue;
+        }
+
+        UsdVariantSets variantsSets = variantPrim.GetVariantSets();
+        if (!variantsSets.HasVariantSet(variantSetName))
+        {
+            continue;
+        }
+
+        UsdVariantSet variantSet = variantsSets.GetVariantSet(variantSetName);
+        const std::string previous = variantSet.GetVariantSelection();
+        variantSet.SetVariantSelection(variantName);
+
+        if (variantSet.GetVariantSelection() == previous)
+        {
+            continue;
+        }
+
+        // The new variant can change the children, so we need to continue
+        // with the updated list.
+        const SdfPath current = prims[i];
+        prims = index->getPrims(path);
+        i = std::find(prims.begin(), prims.end(), current) - prims.begin();
+    }
 }
 
 void WalterUSDCommonUtils::setVariantUSD(
@@ -639,39 +1325,211 @@ bool WalterUSDCommonUtils::hideAllExceptedThis(
     return setVisibility(stage, primPath, true);
 }
 
-bool WalterUSDCommonUtils::expressionIsMatching(
-    UsdStageRefPtr stage,
-    const char* expression)
+/**
+ * @brief Returns the beginning of the regex that doesn't have special symbols.
+ * All the strings that match the regex start with it.
+ *
+ * @param expression The regex.
+ *
+ * @return The literal prefix. It can be empty.
+ */
+std::string getLiteralPrefix(const std::string& expression)
 {
-    if (!stage)
+    // The alternatives can start with anything.
+    if (expression.find('|') != std::string::npos)
     {
-        return false;
+        return {};
     }
 
-    bool expressionIsValid = false;
+    size_t end = expression.find_first_of(".[]{}()\\*+?^$");
+    if (end == std::string::npos)
+    {
+        return expression;
+    }
 
-    // Generate a regexp object.
-    void* regexp = WalterCommon::createRegex(expression);
+    // These quantifiers make the previous character optional.
+    if (end > 0 && strchr("*?{", expression[end]))
+    {
+        end--;
+    }
 
-    UsdPrimRange range(stage->GetPrimAtPath(SdfPath::AbsoluteRootPath()));
-    for (const UsdPrim& prim : range)
+    return expression.substr(0, end);
+}
+
+/**
+ * @brief The sorted table of the prim paths of the stage. The prims that start
+ * with a string are in the same range of the table, so the expressions are
+ * only evaluated on the prims that start with the literal part of the
+ * expression. The table is rebuilt when the stage is recomposed.
+ */
+class PathIndex : public TfWeakBase
+{
+public:
+    PathIndex(const UsdStageRefPtr& stage) : mStage(stage), mDirty(true)
+    {
+        mKey = TfNotice::Register(
+            TfCreateWeakPtr(this),
+            &PathIndex::onObjectsChanged,
+            UsdStageWeakPtr(stage));
+    }
+
+    ~PathIndex() { TfNotice::Revoke(mKey); }
+
+    /**
+     * @brief Returns the paths of the prims that start with the expression or
+     * match the regex. The paths are in the traversal order.
+     *
+     * @param expression The regex.
+     * @param firstOnly Stop at the first matching prim.
+     */
+    SdfPathVector match(const char* expression, bool firstOnly)
     {
-        const SdfPath& path = prim.GetPath();
-        std::string current = path.GetString();
+        std::lock_guard<std::mutex> lock(mMutex);
+        update();
+
+        const std::string prefix = getLiteralPrefix(expression);
+
+        // All the candidates start with the prefix.
+        auto first = std::lower_bound(
+            mEntries.begin(),
+            mEntries.end(),
+            prefix,
+            [](const Entry& entry, const std::string& prefix) {
+                return entry.path < prefix;
+            });
+        auto last = std::upper_bound(
+            first,
+            mEntries.end(),
+            prefix,
+            [](const std::string& prefix, const Entry& entry) {
+                return entry.path.compare(0, prefix.size(), prefix) > 0;
+            });
+
+        // Generate a regexp object.
+        void* regexp = WalterCommon::createRegex(expression);
 
         // TODO: What if we have '/cube' and '/cubeBig/shape' objects? If we
         // try to select the first one, both of them will be selected.
-        if (boost::starts_with(current, expression) ||
-            WalterCommon::searchRegex(regexp, current))
+        auto isMatching = [expression, regexp](const Entry& entry) {
+            return boost::starts_with(entry.path, expression) ||
+                WalterCommon::searchRegex(regexp, entry.path);
+        };
+
+        std::vector<const Entry*> matching;
+        if (firstOnly)
         {
-            expressionIsValid = true;
-            break;
+            auto it = std::find_if(first, last, isMatching);
+            if (it != last)
+            {
+                matching.push_back(&(*it));
+            }
+        }
+        else
+        {
+            std::vector<char> isMatched(std::distance(first, last), 0);
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, isMatched.size()),
+                [&](const tbb::blocked_range<size_t>& r) {
+                    for (size_t i = r.begin(); i != r.end(); ++i)
+                    {
+                        isMatched[i] = isMatching(*(first + i));
+                    }
+                });
+
+            for (size_t i = 0; i < isMatched.size(); i++)
+            {
+                if (isMatched[i])
+                {
+                    matching.push_back(&(*(first + i)));
+                }
+            }
+
+            std::sort(
+                matching.begin(),
+                matching.end(),
+                [](const Entry* a, const Entry* b) {
+                    return a->order < b->order;
+                });
+        }
+
+        // Delete a regexp object.
+        WalterCommon::clearRegex(regexp);
+
+        SdfPathVector result;
+        result.reserve(matching.size());
+        for (const Entry* entry : matching)
+        {
+            result.push_back(entry->sdfPath);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Checks if the stage of the index is destroyed.
+     */
+    bool isExpired() const { return !mStage; }
+
+private:
+    void onObjectsChanged(const UsdNotice::ObjectsChanged& notice)
+    {
+        if (!notice.GetResyncedPaths().empty())
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDirty = true;
+        }
+    }
+
+    void update()
+    {
+        if (!mDirty)
+        {
+            return;
         }
+
+        mEntries.clear();
+
+        UsdPrimRange range(mStage->GetPrimAtPath(SdfPath::AbsoluteRootPath()));
+        for (const UsdPrim& prim : range)
+        {
+            const SdfPath& path = prim.GetPath();
+            mEntries.push_back({path.GetString(), path, mEntries.size()});
+        }
+
+        tbb::parallel_sort(
+            mEntries.begin(),
+            mEntries.end(),
+            [](const Entry& a, const Entry& b) { return a.path < b.path; });
+
+        mDirty = false;
     }
-    // Delete a regexp object.
-    WalterCommon::clearRegex(regexp);
 
-    return expressionIsValid;
+    struct Entry
+    {
+        std::string path;
+        SdfPath sdfPath;
+        // The position in the traversal.
+        size_t order;
+    };
+
+    UsdStageWeakPtr mStage;
+    TfNotice::Key mKey;
+    std::mutex mMutex;
+    bool mDirty;
+    std::vector<Entry> mEntries;
+};
+
+bool WalterUSDCommonUtils::expressionIsMatching(
+    UsdStageRefPtr stage,
+    const char* expression)
+{
+    if (!stage)
+    {
+        return false;
+    }
+
+    std::shared_ptr<PathIndex> index = getStageIndex<PathIndex>(stage);
+    return !index->match(expression, true).empty();
 }
 
 std::vector<UsdPrim> WalterUSDCommonUtils::primsMatchingExpression(
@@ -684,25 +1542,12 @@ std::vector<UsdPrim> WalterUSDCommonUtils::primsMatchingExpression(
         return res;
     }
 
-    // Generate a regexp object.
-    void* regexp = WalterCommon::createRegex(expression);
-
-    UsdPrimRange range(stage->GetPrimAtPath(SdfPath::AbsoluteRootPath()));
-    for (const UsdPrim& prim : range)
+    std::shared_ptr<PathIndex> index = getStageIndex<PathIndex>(stage);
+    for (const SdfPath& path : index->match(expression, false))
     {
-        const SdfPath& path = prim.GetPath();
-        std::string current = path.GetString();
-
-        // TODO: What if we have '/cube' and '/cubeBig/shape' objects? If we
-        // try to select the first one, both of them will be selected.
-        if (boost::starts_with(current, expression) ||
-            WalterCommon::searchRegex(regexp, current))
-        {
-            res.push_back(prim);
-        }
+        res.push_back(stage->GetPrimAtPath(path));
     }
-    // Delete a regexp object.
-    WalterCommon::clearRegex(regexp);
+
     return res;
 }
 
@@ -788,6 +1633,33 @@ std::string WalterUSDCommonUtils::purpose(
     return "default";
 }
 
+/**
+ * @brief Builds the information about the master of the instance.
+ *
+ * @param prim The instance.
+ *
+ * @return The name of the prim the master represents and the variants.
+ */
+WalterUSDCommonUtils::MasterPrimInfo getMasterPrimInfo(const UsdPrim& prim)
+{
+    const auto& primStack = prim.GetPrimStack();
+
+    // This Prim is the 'real' one represented by the masterPrim, we need it's
+    // name for material assignment and better naming in Katana.
+    SdfPrimSpec referencedPrim = primStack.back().GetSpec();
+
+    // Also get the eventual list of variant selection (just the variant name)
+    // to help construct a meaningful katana location for the master location
+    // (instance source).
+    SdfHandle<SdfPrimSpec> handle = *(primStack.rbegin() + 1);
+    SdfPrimSpec variantsPrim = handle.GetSpec();
+
+    std::vector<std::string> variantsSelection =
+        WalterUSDCommonUtils::getVariantsSelection(variantsPrim.GetPath());
+
+    return {referencedPrim.GetName(), variantsSelection};
+}
+
 WalterUSDCommonUtils::MastersInfoMap WalterUSDCommonUtils::getMastersInfo(
     UsdStageRefPtr stage
 )
@@ -799,51 +1671,76 @@ WalterUSDCommonUtils::MastersInfoMap WalterUSDCommonUtils::getMastersInfo(
         return mastersInfo;
     }
 
-    for (UsdPrim prim: stage->Traverse())
+    // Split the stage to the subtrees to traverse them in parallel. We expand
+    // the prims in place, so the subtrees are in the traversal order.
+    static const size_t minSubtrees = 64;
+    std::vector<UsdPrim> subtrees;
+    for (const UsdPrim& child : stage->GetPseudoRoot().GetChildren())
     {
-        // If the primitive is not an instance there is no master prim
-        // information to look for...
-        if (!prim.IsInstance())
-        {
-            continue;
-        }
+        subtrees.push_back(child);
+    }
 
-        // ... Otherwise get the master primitive and look for more information
-        // if it's the first time we encounter it.
-        UsdPrim masterPrim = prim.GetMaster();
+    bool expanded = true;
+    while (expanded && subtrees.size() < minSubtrees)
+    {
+        expanded = false;
 
-        if (mastersInfo.find(masterPrim.GetName()) ==
-            mastersInfo.end())
+        std::vector<UsdPrim> next;
+        for (const UsdPrim& prim : subtrees)
         {
-            const auto& primStack = prim.GetPrimStack();
+            auto children = prim.GetChildren();
+            if (prim.IsInstance() || children.empty())
+            {
+                next.push_back(prim);
+                continue;
+            }
 
-            // This Prim is the 'real' one represented by the masterPrim, we
-            // need it's name for material assignment and better naming in
-            // Katana.
-            SdfPrimSpec referencedPrim = primStack.back().GetSpec();
+            next.insert(next.end(), children.begin(), children.end());
+            expanded = true;
+        }
 
-            // Also get the eventual list of variant selection (just the variant
-            // name) to help construct a meaningful katana location for the
-            // master location (instance source).
-            SdfHandle<SdfPrimSpec> handle = *(primStack.rbegin() + 1);
-            SdfPrimSpec variantsPrim = handle.GetSpec();
+        subtrees.swap(next);
+    }
 
-            std::vector<std::string> variantsSelection =
-                WalterUSDCommonUtils::getVariantsSelection(
-                    variantsPrim.GetPath()
-                );
+    // The first instance of each master of each subtree.
+    typedef std::vector<std::pair<std::string, UsdPrim>> Instances;
+    std::vector<Instances> instances(subtrees.size());
 
-            // Build a MasterPrimInfo object with the two previous information
-            // and mapped it with the USD master primitive name.
-            WalterUSDCommonUtils::MasterPrimInfo masterInfo = {
-                referencedPrim.GetName(),
-                variantsSelection
-            };
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, subtrees.size()),
+        [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                std::unordered_set<std::string> masters;
+                for (const UsdPrim& prim : UsdPrimRange(subtrees[i]))
+                {
+                    // If the primitive is not an instance there is no master
+                    // prim information to look for.
+                    if (!prim.IsInstance())
+                    {
+                        continue;
+                    }
+
+                    std::string masterName = prim.GetMaster().GetName();
+                    if (masters.insert(masterName).second)
+                    {
+                        instances[i].emplace_back(masterName, prim);
+                    }
+                }
+            }
+        });
 
-            mastersInfo.emplace(
-                masterPrim.GetName(),
-                masterInfo
-            );
+    // Look for more information if it's the first time we encounter the
+    // master. It's the same order as the serial traversal.
+    for (const Instances& subtreeInstances : instances)
+    {
+        for (const auto& instance : subtreeInstances)
+        {
+            if (mastersInfo.find(instance.first) == mastersInfo.end())
+            {
+                mastersInfo.emplace(
+                    instance.first, getMasterPrimInfo(instance.second));
+            }
         }
     }
 
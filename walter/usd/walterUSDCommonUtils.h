@@ -13,7 +13,10 @@ PXR_NAMESPACE_USING_DIRECTIVE
 namespace WalterUSDCommonUtils
 {
 /**
- * @brief Compose and open several usd layers.
+ * @brief Compose and open several usd layers. The cache of the resolver is not
+ * cleared here, so the paths resolved by the previous stages are reused. To
+ * resolve the sublayers once per stage, create ArResolverScopedCache before
+ * calling this function and keep it until the stage is opened.
  *
  * @param path One or several USD layers separated with ":" symbol.
  *
@@ -30,6 +33,13 @@ SdfLayerRefPtr getUSDLayer(const std::string& path);
  */
 SdfLayerRefPtr getUSDLayer(const std::vector<std::string>& paths);
 
+/**
+ * @brief Clears the cache of the resolver of the process. It should only be
+ * called when the files were changed on the disk, because all the paths are
+ * resolved again after that.
+ */
+void clearResolverCache();
+
 /**
  * @brief Creates or returns an anonymous layer that can be used to modify the
  * stage.
@@ -43,6 +53,68 @@ SdfLayerRefPtr getUSDLayer(const std::vector<std::string>& paths);
  */
 SdfLayerRefPtr getAnonymousLayer(UsdStageRefPtr stage, const std::string& name);
 
+/**
+ * @brief Computes the hash of the given strings. The result only depends on the
+ * content, so it's the same from one session to another and it can be used to
+ * form the names of the layers and the render nodes.
+ *
+ * @param strings The strings to hash. The order matters.
+ *
+ * @return The hash as a string of 16 hexadecimal digits.
+ */
+std::string getContentHash(const std::vector<std::string>& strings);
+
+/**
+ * @brief Computes the hash of the given string.
+ *
+ * @param str The string to hash.
+ *
+ * @return The hash as a string of 16 hexadecimal digits.
+ */
+std::string getContentHash(const std::string& str);
+
+/**
+ * @brief Encodes the layer to the compact binary form. The layer is saved with
+ * the USD binary format (crate) and encoded to base64, so the result can be
+ * saved to an attribute of Maya or a parameter of Arnold. It's much smaller
+ * than usda when the layer has arrays and it's parsed much faster.
+ *
+ * @param layer The layer to encode.
+ *
+ * @return The encoded layer. If it can't be saved as crate, it's the usda text.
+ * It's empty only if the layer can't be saved at all.
+ */
+std::string getLayerAsBinary(const SdfLayerHandle& layer);
+
+/**
+ * @brief Sets the content of the layer from the string. The string can be
+ * either usda text or the binary form produced by getLayerAsBinary.
+ *
+ * @param layer The layer to fill.
+ * @param str The usda text or the encoded binary layer.
+ *
+ * @return True if succeded, false otherwise.
+ */
+bool importLayerFromString(const SdfLayerHandle& layer, const std::string& str);
+
+/**
+ * @brief Returns the layer with the given content. The layers are cached in the
+ * process by the hash of the content, so the same string is parsed only once
+ * and all the stages that use it share the same layer. The returned layer
+ * should not be modified.
+ *
+ * @param content The usda text or the encoded binary layer.
+ *
+ * @return The shared layer or an empty pointer if the content can't be parsed.
+ */
+SdfLayerRefPtr getSharedLayer(const std::string& content);
+
+/**
+ * @brief Releases all the layers cached by getSharedLayer. The stages that
+ * still use them keep them alive.
+ */
+void clearSharedLayers();
+
 /**
  * @brief Gets or creates the variants layer and sets its content from external
  * references (e.g Maya scene).
@@ -122,6 +194,8 @@ std::vector<std::string> dirUSD(UsdStageRefPtr stage, const char* primPath);
  * @param time The time.
  * @param attributeOnly If true, only attributes properties (no relation-ship)
  * will be extracted.
+ * @param maxElementCount The maximum number of the elements of the arrays to
+ * convert. The rest of the array is never read. -1 converts all of them.
  *
  * @return The properties (as an array of json).
  */
@@ -129,7 +203,8 @@ std::vector<std::string> propertiesUSD(
     UsdStageRefPtr stage,
     const char* primPath,
     double time,
-    bool attributeOnly = true);
+    bool attributeOnly = true,
+    int maxElementCount = -1);
 
 /**
  * @brief Fills result with all the USD variants of the stage.
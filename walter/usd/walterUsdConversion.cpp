@@ -3,6 +3,7 @@
 #include "walterUsdConversion.h"
 #include <pxr/base/gf/matrix4d.h>
 #include <pxr/base/gf/vec3f.h>
+#include <unordered_map>
 
 namespace WalterUSDToString
 {
@@ -19,55 +20,54 @@ namespace WalterUSDToString
 
 // Generate extern template declarations in the header
 #define MY_SCALAR_TEMPLATE(r, data, arg) \
-    template <> std::string convert<arg>(const arg& value) \
+    template <> void append<arg>(const arg& value, std::string& ioStr) \
     { \
-        return std::to_string(value); \
+        ioStr += std::to_string(value); \
     }
 
 // Generate extern template declarations in the header
 #define MY_VECTOR_TEMPLATE(r, data, arg) \
-    template <> std::string convert<arg>(const arg& value) \
+    template <> void append<arg>(const arg& value, std::string& ioStr) \
     { \
-        return convertDim(value, arg::dimension); \
+        appendDim(value, arg::dimension, ioStr); \
     }
 
 // Generate extern template declarations in the header
 #define MY_MATRIX_TEMPLATE(r, data, arg) \
-    template <> std::string convert<arg>(const arg& value) \
+    template <> void append<arg>(const arg& value, std::string& ioStr) \
     { \
-        return convertDim(value, arg::numRows * arg::numColumns); \
+        appendDim(value, arg::numRows * arg::numColumns, ioStr); \
     }
 
 // Generate extern template declarations in the header
 #define MY_QUAT_TEMPLATE(r, data, arg) \
-    template <> std::string convert<arg>(const arg& value) \
+    template <> void append<arg>(const arg& value, std::string& ioStr) \
     { \
         const typename arg::ScalarType* rawBuffer = \
             value.GetImaginary().GetArray(); \
-        std::string str = "[";\
+        ioStr += "[";\
         for (unsigned j = 0; j < 3; ++j) \
         { \
-            str += convert(rawBuffer[j]); \
-            str += ", "; \
+            append(rawBuffer[j], ioStr); \
+            ioStr += ", "; \
         } \
-        str += convert(value.GetReal()); \
-        str += "]"; \
-        return str; \
+        append(value.GetReal(), ioStr); \
+        ioStr += "]"; \
     }
 
-template <typename T> std::string convertDim(const T& value, int dim)
+template <typename T>
+void appendDim(const T& value, int dim, std::string& ioStr)
 {
     const typename T::ScalarType* rawBuffer = value.GetArray();
 
-    std::string str = "[";
+    ioStr += "[";
     for (unsigned j = 0; j < dim; ++j)
     {
-        str += convert(rawBuffer[j]);
+        append(rawBuffer[j], ioStr);
         if (j < dim - 1)
-            str += ", ";
+            ioStr += ", ";
     }
-    str += "]";
-    return str;
+    ioStr += "]";
 }
 
 BOOST_PP_SEQ_FOR_EACH(MY_SCALAR_TEMPLATE, _, MY_SCALARS)
@@ -75,9 +75,10 @@ BOOST_PP_SEQ_FOR_EACH(MY_VECTOR_TEMPLATE, _, MY_VECTORS)
 BOOST_PP_SEQ_FOR_EACH(MY_MATRIX_TEMPLATE, _, MY_MATRICES)
 BOOST_PP_SEQ_FOR_EACH(MY_QUAT_TEMPLATE, _, MY_QUATS)
 
-template <> std::string convert<std::string>(const std::string& value)
+template <>
+void append<std::string>(const std::string& value, std::string& ioStr)
 {
-    return value;
+    ioStr += value;
 }
 
 #undef MY_SCALARS
@@ -92,106 +93,194 @@ template <> std::string convert<std::string>(const std::string& value)
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
+namespace
+{
+// The tables to find the conversion function by the name of the USD type. It's
+// faster than comparing the type with all the supported types.
+typedef std::string (*ScalarConverter)(UsdAttribute const&, UsdTimeCode const&);
+typedef std::string (*ArrayConverter)(
+    UsdAttribute const&,
+    UsdTimeCode const&,
+    int,
+    int&);
+
+typedef std::unordered_map<TfToken, ScalarConverter, TfToken::HashFunctor>
+    ScalarConverters;
+typedef std::unordered_map<TfToken, ArrayConverter, TfToken::HashFunctor>
+    ArrayConverters;
+
+const ScalarConverters& getScalarConverters()
+{
+    static const ScalarConverters converters = {
+        {SdfValueTypeNames->Bool.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<bool>},
+        {SdfValueTypeNames->UChar.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<uint8_t>},
+        {SdfValueTypeNames->Int.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<int32_t>},
+        {SdfValueTypeNames->UInt.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<uint32_t>},
+        {SdfValueTypeNames->Int64.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<int64_t>},
+        {SdfValueTypeNames->UInt64.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<uint64_t>},
+        {SdfValueTypeNames->Float.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<float>},
+        {SdfValueTypeNames->Double.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<double>},
+        {SdfValueTypeNames->String.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<std::string>},
+        {SdfValueTypeNames->Token.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<std::string>},
+        {SdfValueTypeNames->Asset.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<std::string>},
+        {SdfValueTypeNames->Matrix2d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfMatrix2d>},
+        {SdfValueTypeNames->Matrix3d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfMatrix3d>},
+        {SdfValueTypeNames->Matrix4d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfMatrix4d>},
+        {SdfValueTypeNames->Frame4d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfMatrix4d>},
+        {SdfValueTypeNames->Quatd.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfQuatd>},
+        {SdfValueTypeNames->Double2.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec2d>},
+        {SdfValueTypeNames->Double3.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Color3d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Vector3d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Normal3d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Point3d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Double4.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec4d>},
+        {SdfValueTypeNames->Color4d.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec4d>},
+        {SdfValueTypeNames->Quatf.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfQuatf>},
+        {SdfValueTypeNames->Float2.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec2f>},
+        {SdfValueTypeNames->Float3.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Color3f.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Vector3f.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Normal3f.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Point3f.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Float4.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec4f>},
+        {SdfValueTypeNames->Color4f.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec4f>},
+        {SdfValueTypeNames->Int2.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec2i>},
+        {SdfValueTypeNames->Int3.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec3i>},
+        {SdfValueTypeNames->Int4.GetAsToken(),
+         &WalterUsdConversion::getAttributeValueAsString<GfVec4i>}};
+
+    return converters;
+}
+
+const ArrayConverters& getArrayConverters()
+{
+    static const ArrayConverters converters = {
+        {SdfValueTypeNames->BoolArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<bool>},
+        {SdfValueTypeNames->UCharArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<uint8_t>},
+        {SdfValueTypeNames->IntArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<int32_t>},
+        {SdfValueTypeNames->UIntArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<uint32_t>},
+        {SdfValueTypeNames->Int64Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<int64_t>},
+        {SdfValueTypeNames->UInt64Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<uint64_t>},
+        {SdfValueTypeNames->FloatArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<float>},
+        {SdfValueTypeNames->DoubleArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<double>},
+        {SdfValueTypeNames->StringArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<std::string>},
+        {SdfValueTypeNames->TokenArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<std::string>},
+        {SdfValueTypeNames->AssetArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<std::string>},
+        {SdfValueTypeNames->Matrix2dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfMatrix2d>},
+        {SdfValueTypeNames->Matrix3dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfMatrix3d>},
+        {SdfValueTypeNames->Matrix4dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfMatrix4d>},
+        {SdfValueTypeNames->Frame4dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfMatrix4d>},
+        {SdfValueTypeNames->QuatdArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfQuatd>},
+        {SdfValueTypeNames->Double2Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec2d>},
+        {SdfValueTypeNames->Double3Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Color3dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Vector3dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Normal3dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Point3dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3d>},
+        {SdfValueTypeNames->Double4Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec4d>},
+        {SdfValueTypeNames->Color4dArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec4d>},
+        {SdfValueTypeNames->QuatfArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfQuatf>},
+        {SdfValueTypeNames->Float2Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec2f>},
+        {SdfValueTypeNames->Float3Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Color3fArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Vector3fArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Normal3fArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Point3fArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3f>},
+        {SdfValueTypeNames->Float4Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec4f>},
+        {SdfValueTypeNames->Color4fArray.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec4f>},
+        {SdfValueTypeNames->Int2Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec2i>},
+        {SdfValueTypeNames->Int3Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec3i>},
+        {SdfValueTypeNames->Int4Array.GetAsToken(),
+         &WalterUsdConversion::getArrayAttributeValueAsString<GfVec4i>}};
+
+    return converters;
+}
+}
+
 std::string WalterUsdConversion::getScalarAttributeValueAsString(
     UsdAttribute const& attr,
     UsdTimeCode const& tc)
 {
-    std::string strValue;
-    const SdfValueTypeName attrTypeName = attr.GetTypeName();
-
-    // Basic type
-    if (attrTypeName == SdfValueTypeNames->Bool)
-        strValue = getAttributeValueAsString<bool>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->UChar)
-        strValue = getAttributeValueAsString<uint8_t>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Int)
-        strValue = getAttributeValueAsString<int32_t>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->UInt)
-        strValue = getAttributeValueAsString<uint32_t>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Int64)
-        strValue = getAttributeValueAsString<int64_t>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->UInt64)
-        strValue = getAttributeValueAsString<uint64_t>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Float)
-        strValue = getAttributeValueAsString<float>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Double)
-        strValue = getAttributeValueAsString<double>(attr, tc);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->String ||
-        attrTypeName == SdfValueTypeNames->Token ||
-        attrTypeName == SdfValueTypeNames->Asset)
-        strValue = getAttributeValueAsString<std::string>(attr, tc);
-
-    // Double array/matrix
-    else if (attrTypeName == SdfValueTypeNames->Matrix2d)
-        strValue = getAttributeValueAsString<GfMatrix2d>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Matrix3d)
-        strValue = getAttributeValueAsString<GfMatrix3d>(attr, tc);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Matrix4d ||
-        attrTypeName == SdfValueTypeNames->Frame4d)
-        strValue = getAttributeValueAsString<GfMatrix4d>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Quatd)
-        strValue = getAttributeValueAsString<GfQuatd>(attr, tc);
+    const ScalarConverters& converters = getScalarConverters();
 
-    else if (attrTypeName == SdfValueTypeNames->Double2)
-        strValue = getAttributeValueAsString<GfVec2d>(attr, tc);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Double3 ||
-        attrTypeName == SdfValueTypeNames->Color3d ||
-        attrTypeName == SdfValueTypeNames->Vector3d ||
-        attrTypeName == SdfValueTypeNames->Normal3d ||
-        attrTypeName == SdfValueTypeNames->Point3d)
-        strValue = getAttributeValueAsString<GfVec3d>(attr, tc);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Double4 ||
-        attrTypeName == SdfValueTypeNames->Color4d)
-        strValue = getAttributeValueAsString<GfVec4d>(attr, tc);
-
-    // Float array/matrix
-    else if (attrTypeName == SdfValueTypeNames->Quatf)
-        strValue = getAttributeValueAsString<GfQuatf>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Float2)
-        strValue = getAttributeValueAsString<GfVec2f>(attr, tc);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Float3 ||
-        attrTypeName == SdfValueTypeNames->Color3f ||
-        attrTypeName == SdfValueTypeNames->Vector3f ||
-        attrTypeName == SdfValueTypeNames->Normal3f ||
-        attrTypeName == SdfValueTypeNames->Point3f)
-        strValue = getAttributeValueAsString<GfVec3f>(attr, tc);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Float4 ||
-        attrTypeName == SdfValueTypeNames->Color4f)
-        strValue = getAttributeValueAsString<GfVec4f>(attr, tc);
-
-    // Int array/matrix
-    else if (attrTypeName == SdfValueTypeNames->Int2)
-        strValue = getAttributeValueAsString<GfVec2i>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Int3)
-        strValue = getAttributeValueAsString<GfVec3i>(attr, tc);
-
-    else if (attrTypeName == SdfValueTypeNames->Int4)
-        strValue = getAttributeValueAsString<GfVec4i>(attr, tc);
+    auto it = converters.find(attr.GetTypeName().GetAsToken());
+    if (it == converters.end())
+    {
+        return {};
+    }
 
-    return strValue;
+    return it->second(attr, tc);
 }
 
 std::string WalterUsdConversion::getArrayAttributeValueAsString(
@@ -200,125 +289,15 @@ std::string WalterUsdConversion::getArrayAttributeValueAsString(
     int maxElementCount,
     int& arraySize)
 {
-    std::string strValue;
-    const SdfValueTypeName& attrTypeName = attr.GetTypeName();
-
-    // Basic type
-    if (attrTypeName == SdfValueTypeNames->BoolArray)
-        strValue = getArrayAttributeValueAsString<bool>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->UCharArray)
-        strValue = getArrayAttributeValueAsString<uint8_t>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->IntArray)
-        strValue = getArrayAttributeValueAsString<int32_t>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->UIntArray)
-        strValue = getArrayAttributeValueAsString<uint32_t>(
-            attr, tc, maxElementCount, arraySize);
+    const ArrayConverters& converters = getArrayConverters();
 
-    else if (attrTypeName == SdfValueTypeNames->Int64Array)
-        strValue = getArrayAttributeValueAsString<int64_t>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->UInt64Array)
-        strValue = getArrayAttributeValueAsString<uint64_t>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->FloatArray)
-        strValue = getArrayAttributeValueAsString<float>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->DoubleArray)
-        strValue = getArrayAttributeValueAsString<double>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->StringArray ||
-        attrTypeName == SdfValueTypeNames->TokenArray ||
-        attrTypeName == SdfValueTypeNames->AssetArray)
-        strValue = getArrayAttributeValueAsString<std::string>(
-            attr, tc, maxElementCount, arraySize);
-
-    // Double array/matrix
-    else if (attrTypeName == SdfValueTypeNames->Matrix2dArray)
-        strValue = getArrayAttributeValueAsString<GfMatrix2d>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->Matrix3dArray)
-        strValue = getArrayAttributeValueAsString<GfMatrix3d>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Matrix4dArray ||
-        attrTypeName == SdfValueTypeNames->Frame4dArray)
-        strValue = getArrayAttributeValueAsString<GfMatrix4d>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->QuatdArray)
-        strValue = getArrayAttributeValueAsString<GfQuatd>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->Double2Array)
-        strValue = getArrayAttributeValueAsString<GfVec2d>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Double3Array ||
-        attrTypeName == SdfValueTypeNames->Color3dArray ||
-        attrTypeName == SdfValueTypeNames->Vector3dArray ||
-        attrTypeName == SdfValueTypeNames->Normal3dArray ||
-        attrTypeName == SdfValueTypeNames->Point3dArray)
-        strValue = getArrayAttributeValueAsString<GfVec3d>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Double4Array ||
-        attrTypeName == SdfValueTypeNames->Color4dArray)
-        strValue = getArrayAttributeValueAsString<GfVec4d>(
-            attr, tc, maxElementCount, arraySize);
-
-    // Float array/matrix
-    else if (attrTypeName == SdfValueTypeNames->QuatfArray)
-        strValue = getArrayAttributeValueAsString<GfQuatf>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->Float2Array)
-        strValue = getArrayAttributeValueAsString<GfVec2f>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Float3Array ||
-        attrTypeName == SdfValueTypeNames->Color3fArray ||
-        attrTypeName == SdfValueTypeNames->Vector3fArray ||
-        attrTypeName == SdfValueTypeNames->Normal3fArray ||
-        attrTypeName == SdfValueTypeNames->Point3fArray)
-        strValue = getArrayAttributeValueAsString<GfVec3f>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (
-        attrTypeName == SdfValueTypeNames->Float4Array ||
-        attrTypeName == SdfValueTypeNames->Color4fArray)
-        strValue = getArrayAttributeValueAsString<GfVec4f>(
-            attr, tc, maxElementCount, arraySize);
-
-    // Int array/matrix
-    else if (attrTypeName == SdfValueTypeNames->Int2Array)
-        strValue = getArrayAttributeValueAsString<GfVec2i>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->Int3Array)
-        strValue = getArrayAttributeValueAsString<GfVec3i>(
-            attr, tc, maxElementCount, arraySize);
-
-    else if (attrTypeName == SdfValueTypeNames->Int4Array)
-        strValue = getArrayAttributeValueAsString<GfVec4i>(
-            attr, tc, maxElementCount, arraySize);
+    auto it = converters.find(attr.GetTypeName().GetAsToken());
+    if (it == converters.end())
+    {
+        return {};
+    }
 
-    return strValue;
+    return it->second(attr, tc, maxElementCount, arraySize);
 }
 
 std::string WalterUsdConversion::getRelationShipValueAsString(
@@ -406,12 +385,19 @@ std::string WalterUsdConversion::constuctStringRepresentation(
     std::string const& strValue,
     int arraySize)
 {
-    std::string jsonStr = "{ ";
-    jsonStr += "\"name\": \"" + name + "\"";
-    jsonStr += ", \"type\": \"" + valueType + "\"";
-    jsonStr += ", \"arraySize\": " + std::to_string(arraySize);
-    jsonStr += ", \"value\": " + strValue;
-    jsonStr += " }";
+    const std::string arraySizeStr = std::to_string(arraySize);
+
+    // Compute the size first to allocate the buffer only once.
+    std::string jsonStr;
+    jsonStr.reserve(
+        name.size() + valueType.size() + arraySizeStr.size() +
+        strValue.size() + 64);
+
+    jsonStr.append("{ \"name\": \"").append(name);
+    jsonStr.append("\", \"type\": \"").append(valueType);
+    jsonStr.append("\", \"arraySize\": ").append(arraySizeStr);
+    jsonStr.append(", \"value\": ").append(strValue);
+    jsonStr.append(" }");
 
     return jsonStr;
 }
@@ -17,7 +17,16 @@ namespace WalterUSDToString
 // member functions without explicitly specializing the containing class due
 // to C++04, §14.7.3/3.
 
-template <typename T> std::string convert(const T& value);
+// Appends the value to the string. It's used to convert big arrays to a single
+// buffer without creating a temporary string for each element.
+template <typename T> void append(const T& value, std::string& ioStr);
+
+template <typename T> std::string convert(const T& value)
+{
+    std::string str;
+    append(value, str);
+    return str;
+}
 }
 
 // Sets of functions to cast USD properties into a json.
@@ -45,7 +54,7 @@ struct WalterUsdConversion
     }
 
     // Gets the value of an attribute array of basic type T (excepted strings)
-    // as a json.
+    // as a json. Only the first maxElementCount elements are converted.
     template <class T>
     static std::string getArrayAttributeValueAsString(
         UsdAttribute const& attr,
@@ -53,23 +62,36 @@ struct WalterUsdConversion
         int maxElementCount,
         int& arraySize)
     {
-        VtArray<T> vtArray = getAttributeValue<VtArray<T>>(attr, tc);
+        // It's const because the non-const access to VtArray copies the data
+        // if it's shared with the layer.
+        const VtArray<T> vtArray = getAttributeValue<VtArray<T>>(attr, tc);
         arraySize = (int)vtArray.size();
         unsigned maxCount = maxElementCount > -1 ?
             std::min(maxElementCount, arraySize) :
             arraySize;
 
-        std::string str = "[";
+        // All the elements are appended to the same buffer. The size is a guess
+        // that is good for the most of the numbers and the vectors.
+        std::string str;
+        str.reserve(2 + maxCount * 16);
+        str.append("[");
         for (unsigned i = 0; i < maxCount; ++i)
         {
-            str += std::is_same<T, std::string>::value
-                ? "\"" + WalterUSDToString::convert(vtArray[i]) + "\""
-                : WalterUSDToString::convert(vtArray[i]);
+            if (std::is_same<T, std::string>::value)
+            {
+                str.append("\"");
+                WalterUSDToString::append(vtArray[i], str);
+                str.append("\"");
+            }
+            else
+            {
+                WalterUSDToString::append(vtArray[i], str);
+            }
 
             if (i < maxCount - 1)
-                str += ", ";
+                str.append(", ");
         }
-        str += "]";
+        str.append("]");
 
         return str;
     }
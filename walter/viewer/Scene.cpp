@@ -4,6 +4,7 @@
 #include "FreeCamera.h"
 #include "walterUSDCommonUtils.h"
 
+#include <pxr/usd/ar/resolverScopedCache.h>
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usdGeom/bboxCache.h>
 #include <pxr/usd/usdGeom/camera.h>
@@ -15,6 +16,7 @@ Scene::Scene(
     const Options& opt,
     FreeCameraPtr camera)
 {
+    ArResolverScopedCache cache;
     SdfLayerRefPtr root = WalterUSDCommonUtils::getUSDLayer(opt.filePath);
     mStage = UsdStage::Open(root);
 